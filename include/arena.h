@@ -0,0 +1,34 @@
+#pragma once
+#include <stddef.h>
+
+/* Bump-pointer arena allocator.
+ *
+ * A compilation allocates its tokens, AST nodes, types and the strings
+ * they own from one arena, and the driver releases all of it with a
+ * single arena_destroy() instead of walking the tree node by node.
+ */
+
+typedef struct Arena Arena;
+
+Arena *arena_create(size_t block_size);
+void   arena_destroy(Arena *arena);
+void  *arena_alloc(Arena *arena, size_t n);
+
+/* Rewind the arena to empty while keeping its blocks mapped, so a
+ * long-lived process (daemon mode) reuses warm memory across compiles
+ * instead of paying mmap/page-fault cost per request. */
+void   arena_reset(Arena *arena);
+
+/* The compile-wide current arena, installed by the driver around a
+ * compilation. While it is installed, the node constructors allocate
+ * from it and the matching free functions skip per-node frees (the
+ * memory belongs to the arena). */
+void   arena_set_current(Arena *arena);
+Arena *arena_current(void);
+int    arena_active(void);
+
+/* Arena-aware allocation helpers: use the current arena when one is
+ * installed, otherwise fall back to the xmalloc family. */
+void  *arena_alloc_current(size_t n);
+char  *arena_strdup_current(const char *s);
+char  *arena_strndup_current(const char *s, size_t n);
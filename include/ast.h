@@ -273,8 +273,12 @@ typedef struct {
     AstNodeArray *elements;
 } AstInitializeList;
 
-/* Represents one node in the abstract syntax tree (AST). */
-/* Represents a node in the abstract syntax tree (AST). */
+/* Represents one node in the abstract syntax tree (AST).
+ *
+ * NOTE: ast_create_node() allocates nodes at header + payload size for
+ * the requested kind, not sizeof(AstNode). Never copy or zero a node
+ * with sizeof(AstNode), and only access the union member that matches
+ * node_type -- the other variants' bytes may not exist. */
 struct AstNode {
     AstNodeType node_type;    
 
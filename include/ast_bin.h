@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ast_pool.h"
+
+/* Compact binary AST serialization (--emit-ast-bin <file>).
+ *
+ * The file is a plain dump of an AstPool (see ast_pool.h): a header
+ * followed by the pool's three position-independent sections --
+ * fixed-size node records, the child index array, and the string
+ * table -- so a reader can mmap the file and index nodes directly
+ * with no pointer fixups.
+ *
+ * Layout (host endianness):
+ *   AstBinHeader
+ *   AstPoolNode[node_count]
+ *   uint32_t    children[child_count]
+ *   char        strings[string_bytes]
+ */
+
+#define AST_BIN_MAGIC   "CAST"
+#define AST_BIN_VERSION 1u
+
+typedef struct {
+    char     magic[4];
+    uint32_t version;
+    uint32_t node_count;
+    uint32_t child_count;
+    uint32_t string_bytes;
+    uint32_t root;            /* node index of the program node */
+} AstBinHeader;
+
+/* Read-only view of a mapped (or heap-loaded) file. */
+typedef struct {
+    const AstBinHeader *header;
+    const AstPoolNode *nodes;
+    const uint32_t *children;
+    const char *strings;
+    void *map;                /* mapping base for ast_bin_close */
+    size_t map_len;
+} AstBinFile;
+
+/* Serialize the tree rooted at root to path. Returns 0 on success. */
+int ast_bin_write(const AstNode *root, const char *path);
+
+/* Map path and validate the header and section bounds. Returns 0 on
+ * success; the view stays valid until ast_bin_close. */
+int ast_bin_open(AstBinFile *f, const char *path);
+void ast_bin_close(AstBinFile *f);
+
+static inline const AstPoolNode *ast_bin_node(const AstBinFile *f, uint32_t i) {
+    return &f->nodes[i];
+}
+
+/* i-th child of node n, or AST_POOL_NONE for an absent slot. */
+static inline uint32_t ast_bin_child(const AstBinFile *f,
+                                     const AstPoolNode *n, uint32_t i) {
+    return f->children[n->first_child + i];
+}
+
+static inline const char *ast_bin_string(const AstBinFile *f, uint32_t off) {
+    return off == AST_POOL_NONE ? NULL : f->strings + off;
+}
@@ -6,31 +6,19 @@
 /* Forward declaration to avoid circular includes */
 typedef struct AstNode AstNode;
 
-typedef struct {
-    DynArray da;   /* element type = AstNode* */
-} AstNodeArray;
-
-/* Initialize the array. */
-void astnode_array_init(AstNodeArray *arr);
-
-/* Create and initialize a new AstNodeArray on the heap. Returns NULL on OOM. */
+/* Specialized AstNode* array: constant element size the compiler can
+ * fold, and 8 inline slots — most block, call-argument and parameter
+ * lists fit without ever touching the heap. Generates AstNodeArray and
+ * astnode_array_init/reserve/push/pop/count/get/dispose. */
+DYNARRAY_DEFINE(AstNodeArray, astnode_array, AstNode *, 8)
+
+/* Create and initialize a new AstNodeArray (current arena when one is
+ * installed). Returns NULL on OOM. */
 AstNodeArray *astnode_array_create(void);
 
-/* Push a node pointer. Returns 0 on success, -1 on OOM. */
-int astnode_array_push(AstNodeArray *arr, AstNode *node);
-
-/* Pop last element (does not free the element). If you want pop+free,
- * call ast_node_free(astnode_array_get(...)) then astnode_array_pop(...). */
-void astnode_array_pop(AstNodeArray *arr);
-
-/* Number of elements. */
-size_t astnode_array_count(AstNodeArray *arr);
-
-/* Get element by index (no bounds check). */
-AstNode *astnode_array_get(AstNodeArray *arr, size_t i);
-
 /* Free the array and all stored AstNode* elements.
- * If you prefer NOT to free the contained nodes, use dynarray_free(&arr->da) directly.
+ * If you prefer NOT to free the contained nodes, use
+ * astnode_array_dispose(arr) directly.
  */
 void astnode_array_free(AstNodeArray *arr);
 
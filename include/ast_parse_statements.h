@@ -115,6 +115,9 @@ AstNode *parse_continue_statement(Parser *p, ParseError *err);
    <Additive>       ::= <Multiplicative> { ( PLUS | MINUS ) <Multiplicative> }
    <Multiplicative> ::= <Unary>          { ( STAR | SLASH | PERCENT ) <Unary> }
 
+   The binary levels above are implemented by one precedence-climbing
+   loop (parse_binary_expr) rather than a function per level.
+
    <Unary>   ::= <PrefixOp> <Unary> | <Postfix>
    <PrefixOp> ::= PLUS | MINUS | BANG | STAR | AMP | PLUSPLUS | MINUSMINUS
 
@@ -128,12 +131,7 @@ AstNode *parse_continue_statement(Parser *p, ParseError *err);
 AstNode *parse_expression(Parser *p, ParseError *err);
 AstNode *parse_assignment(Parser *p, AstNode *lhs, ParseError *err);
 
-AstNode *parse_logical_or(Parser *p, ParseError *err);
-AstNode *parse_logical_and(Parser *p, ParseError *err);
-AstNode *parse_equality(Parser *p, ParseError *err);
-AstNode *parse_relational(Parser *p, ParseError *err);
-AstNode *parse_additive(Parser *p, ParseError *err);
-AstNode *parse_multiplicative(Parser *p, ParseError *err);
+AstNode *parse_binary_expr(Parser *p, ParseError *err, int min_prec);
 
 AstNode *parse_unary(Parser *p, ParseError *err);
 AstNode *parse_postfix(Parser *p, ParseError *err);
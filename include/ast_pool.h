@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ast.h"
+
+/* Flattened index-based AST pool.
+ *
+ * An alternative storage backend to the AstNode pointer graph: the
+ * whole tree is packed into one contiguous record array (post-order,
+ * so every child precedes its parent), children are 32-bit node
+ * indices through a CSR-style (first_child, child_count) window into
+ * one child array, and strings are byte offsets into one string
+ * table. Child references are half the size of pointers, full-tree
+ * passes become sequential scans over the record array, and the
+ * binary AST serialization (--emit-ast-bin) is a plain buffer write
+ * of the three sections.
+ *
+ * Child windows per node kind (AST_POOL_NONE marks an absent slot):
+ *   PROGRAM / BLOCK / INITIALIZER_LIST   each decl/stmt/element
+ *   VARIABLE_DECLARATION                 [type, initializer]
+ *   FUNCTION_DECLARATION                 [return_type, body, params...]
+ *   PARAM / EXPR_STATEMENT / RETURN      [child]
+ *   IF                                   [cond, then, else]
+ *   WHILE                                [cond, body]
+ *   FOR                                  [init, cond, post, body]
+ *   BINARY / ASSIGNMENT / SUBSCRIPT      [left, right]
+ *   UNARY / POSTFIX                      [expr]
+ *   CALL                                 [callee, args...]
+ *   TYPE                                 [return_type, sizes..., params...]
+ */
+
+#define AST_POOL_NONE 0xFFFFFFFFu
+
+/* node flags */
+#define AST_POOL_F_CONST_EXPR 0x01u /* is_const_expr */
+#define AST_POOL_F_HAS_CV     0x02u /* const_value present (kind in aux) */
+
+/* aux bits for AST_TYPE nodes (aux is the LiteralType elsewhere) */
+#define AST_POOL_T_CONST    0x01u   /* base_is_const */
+#define AST_POOL_T_FUNCTION 0x02u   /* is_function */
+
+typedef struct {
+    uint8_t  kind;            /* AstNodeType */
+    uint8_t  op;              /* OpKind (expressions), OP_NULL otherwise */
+    uint8_t  aux;             /* LiteralType / AST_POOL_T_* bits */
+    uint8_t  flags;           /* AST_POOL_F_* */
+    uint32_t name;            /* string offset: name / identifier / literal
+                                 text / base type; AST_POOL_NONE if absent */
+    uint64_t payload;         /* const_value bits; for AST_TYPE:
+                                 pre_stars | post_stars<<16 |
+                                 n_sizes<<32 | n_params<<48 */
+    uint32_t first_child;
+    uint32_t child_count;
+} AstPoolNode;
+
+typedef struct {
+    AstPoolNode *nodes;
+    uint32_t node_count;
+    uint32_t *children;
+    uint32_t child_count;
+    char *strings;
+    uint32_t string_bytes;
+    uint32_t root;            /* node index of the program node */
+} AstPool;
+
+/* Flatten the tree rooted at root into pool. Returns 0 on success;
+ * the pool owns its buffers until ast_pool_free. */
+int  ast_pool_build(AstPool *pool, const AstNode *root);
+void ast_pool_free(AstPool *pool);
+
+static inline const AstPoolNode *ast_pool_node(const AstPool *p, uint32_t i) {
+    return &p->nodes[i];
+}
+
+/* i-th child of node n, or AST_POOL_NONE for an absent slot. */
+static inline uint32_t ast_pool_child(const AstPool *p,
+                                      const AstPoolNode *n, uint32_t i) {
+    return p->children[n->first_child + i];
+}
+
+static inline const char *ast_pool_string(const AstPool *p, uint32_t off) {
+    return off == AST_POOL_NONE ? NULL : p->strings + off;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+/* Front-end benchmark suite (--bench).
+ *
+ * Generates deterministic corpora of increasing size, times each phase
+ * via run_compiler_timed() with warmup and repetition, and prints
+ * per-phase throughput. When json_path is non-NULL a line of JSON per
+ * (config, phase) pair is written there; when min_parse_mbps > 0 the
+ * run exits non-zero if any config's median parse throughput falls
+ * below it, so CI can gate on regressions.
+ */
+int bench_run_all(const char *json_path, double min_parse_mbps);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "scope.h"
+
+/* On-disk compilation cache (--cache <dir>).
+ *
+ * Entries are keyed by a content hash of the loaded source buffer, so a
+ * warm run costs little more than hashing the bytes: on a hit the
+ * lex/parse/semantic phases are skipped and the cached symbol table
+ * summary is replayed. Only successful compiles are cached; files that
+ * fail are recompiled every run so their diagnostics stay fresh.
+ * Entries are written atomically (temp file + rename), which keeps the
+ * cache safe under the parallel multi-file mode.
+ */
+
+/* FNV-1a over the source bytes; the cache entry filename. */
+unsigned long cache_hash_source(const char *data, size_t len);
+
+/* Look up hash in dir. On a hit returns true and, when print_symbols is
+ * set, replays the cached symbol table dump to stdout. */
+bool cache_lookup(const char *dir, unsigned long hash, bool print_symbols);
+
+/* Record a successful compile of the source hashing to hash: the global
+ * scope's function and variable symbols, one line each. Best-effort --
+ * failures are silent and the next run simply misses. */
+void cache_store(const char *dir, unsigned long hash, const Scope *scope);
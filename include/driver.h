@@ -10,11 +10,34 @@ typedef struct {
     bool show_time;
     bool show_symbol_table;
     bool show_hierarchical_types;
-    const char *filename;
+    bool show_stats;          /* print hot-path counters after the compile */
+    bool show_mem_stats;      /* print per-phase allocation totals and peak RSS */
+    const char *cache_dir;    /* compilation cache directory, NULL = off */
+    const char *emit_ast_bin; /* binary AST output path, NULL = off */
+    const char *tokens_bin;   /* binary token stream path, NULL = off */
+    bool analyze_bodies;      /* run function body analysis (phase two) */
+    bool stream;              /* fuse lex+parse: pull tokens through a ring */
+    const char *filename;     /* single-file mode */
+    const char **filenames;   /* multi-file mode: compiled by a worker pool */
+    size_t num_files;
+    size_t jobs;              /* worker threads; 0 = one per online CPU */
 } CompilerOptions;
 
+/* Per-file phase timings (milliseconds). */
+typedef struct {
+    double load_ms, lex_ms, parse_ms, sem_ms, total_ms;
+} CompilerTimings;
+
 /* Public API: run the compiler on options. Returns EXIT_SUCCESS/EXIT_FAILURE */
 int run_compiler(const CompilerOptions *opts);
 
 /* Helper used by tests to call run_compiler */
 int run_compiler_once(const CompilerOptions *opts);
+
+/* Like run_compiler_once but reports phase timings (used by --bench). */
+int run_compiler_timed(const CompilerOptions *opts, CompilerTimings *times);
+
+/* Resident mode: serve compile requests from stdin (one per line:
+ * per-compile flags plus a file path, answered with "done <rc>").
+ * Startup, lexer tables and arena blocks are shared across requests. */
+int run_compiler_daemon(const CompilerOptions *opts);
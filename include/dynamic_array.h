@@ -1,5 +1,7 @@
 #pragma once
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 typedef struct {
     void  *data;       /* contiguous buffer */
@@ -38,3 +40,79 @@ void remove_element(DynArray *da, size_t index);
 
 /* Convenience: number of elements */
 static inline size_t dynarray_count(DynArray *da) { return da->count; }
+
+/* -----------------------------------------------------------------
+ * Type-specialized arrays.
+ *
+ * DynArray keeps elem_size as a runtime value, so every push is an
+ * opaque memcpy and every get a multiply. For hot element types,
+ * DYNARRAY_DEFINE generates a variant with the element size baked in
+ * (push/get inline to a store and an indexed load) and inline_cap
+ * elements of in-struct storage, so short lists never touch the heap.
+ *
+ * The struct must not be moved by value once initialized: data points
+ * into inline_items until the array spills.
+ *
+ *   DYNARRAY_DEFINE(AstNodeArray, astnode_array, AstNode *, 8)
+ *
+ * generates AstNodeArray plus astnode_array_init/reserve/push/pop/
+ * count/get/dispose. dispose frees the spill buffer only; elements
+ * the caller owns must be released before it.
+ * ----------------------------------------------------------------- */
+#define DYNARRAY_DEFINE(Name, prefix, Type, inline_cap)                       \
+    typedef struct {                                                          \
+        Type  *data;       /* inline_items until the array spills */          \
+        size_t count;                                                         \
+        size_t capacity;                                                      \
+        Type   inline_items[inline_cap];                                      \
+    } Name;                                                                   \
+                                                                              \
+    static inline void prefix##_init(Name *a) {                              \
+        a->data = a->inline_items;                                           \
+        a->count = 0;                                                        \
+        a->capacity = (inline_cap);                                          \
+    }                                                                         \
+                                                                              \
+    static inline int prefix##_reserve(Name *a, size_t min_capacity) {       \
+        if (a->capacity >= min_capacity) return 0;                           \
+        size_t newcap = a->capacity * 2;                                     \
+        while (newcap < min_capacity) newcap *= 2;                           \
+        if (a->data == a->inline_items) {                                    \
+            Type *buf = malloc(newcap * sizeof(Type));                       \
+            if (!buf) return -1;                                             \
+            memcpy(buf, a->inline_items, a->count * sizeof(Type));           \
+            a->data = buf;                                                   \
+        } else {                                                             \
+            Type *buf = realloc(a->data, newcap * sizeof(Type));             \
+            if (!buf) return -1;                                             \
+            a->data = buf;                                                   \
+        }                                                                     \
+        a->capacity = newcap;                                                \
+        return 0;                                                            \
+    }                                                                         \
+                                                                              \
+    static inline int prefix##_push(Name *a, Type v) {                       \
+        if (a->count == a->capacity &&                                       \
+            prefix##_reserve(a, a->count + 1) != 0) return -1;               \
+        a->data[a->count++] = v;                                             \
+        return 0;                                                            \
+    }                                                                         \
+                                                                              \
+    static inline void prefix##_pop(Name *a) {                               \
+        if (a->count) a->count--;                                            \
+    }                                                                         \
+                                                                              \
+    static inline size_t prefix##_count(const Name *a) {                     \
+        return a->count;                                                     \
+    }                                                                         \
+                                                                              \
+    static inline Type prefix##_get(const Name *a, size_t i) {               \
+        return a->data[i];                                                   \
+    }                                                                         \
+                                                                              \
+    static inline void prefix##_dispose(Name *a) {                           \
+        if (a->data != a->inline_items) free(a->data);                       \
+        a->data = a->inline_items;                                           \
+        a->count = 0;                                                        \
+        a->capacity = (inline_cap);                                          \
+    }
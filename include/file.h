@@ -3,6 +3,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+/* A loaded source file: NUL-terminated text the lexer reads in place.
+ * Backed by a read-only mmap when possible, a heap buffer otherwise. */
+typedef struct {
+    char  *data;
+    size_t len;
+    int    is_mmap;
+} SourceFile;
+
+int  source_file_open(SourceFile *sf, const char *filename);
+void source_file_close(SourceFile *sf);
 
 char *read_file(const char *filename);
 void free_file_content(char *content);
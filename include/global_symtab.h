@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "symbol_table.h"
+
+/* Process-wide symbol table for cross-file (whole-program) analysis.
+ *
+ * Per-file analysis builds one Scope per file and throws it away, so
+ * a call cannot be resolved against a function declared in another
+ * file. When a multi-file run is active, compile workers publish
+ * their top-level function signatures here and can look up names
+ * published by other files.
+ *
+ * The table is sharded by key hash: each shard is its own
+ * SymbolTable behind its own mutex, so parallel workers only contend
+ * when two names land in the same shard. Published symbols own heap
+ * clones of their name and type (type_clone_heap), because the
+ * originals live in per-compile arenas and intern pools that are
+ * torn down after each file.
+ */
+
+#define GLOBAL_SYMTAB_SHARDS 16
+
+void global_symtab_init(void);
+void global_symtab_destroy(void);
+
+/* 1 between init and destroy; publish/lookup are no-ops otherwise. */
+int global_symtab_enabled(void);
+
+/* Publish a function signature (name and type are deep-copied).
+ * Returns false if the name was already published — a duplicate
+ * definition in another file. */
+bool global_symtab_publish(const char *name, const Type *type);
+
+/* Borrowed pointer, stable until global_symtab_destroy (entries are
+ * never removed). NULL if absent or the table is not enabled. */
+Symbol *global_symtab_lookup(const char *name);
+
+size_t global_symtab_size(void);
@@ -2,21 +2,27 @@
 
 #include <stddef.h>
 #include <stdbool.h>
-#include "dynamic_array.h"
 
 /* -----------------------------
-   HashMap API (separate chaining)
+   HashMap API (open addressing)
+
+   Keys, values and cached hashes live in one flat slot array probed
+   linearly, so a lookup touches consecutive cache lines instead of
+   chasing per-bucket allocations. Slot state is encoded in the cached
+   hash (0 = empty, 1 = tombstone; real hashes are remapped above 1).
    ----------------------------- */
 
 typedef struct {
+    size_t hash;   /* cached key hash; also encodes slot state */
     void *key;
     void *value;
-} KeyValue;
+} HashSlot;
 
 typedef struct {
-    DynArray *buckets;     /* array of buckets, each bucket is a DynArray of KeyValue */
-    size_t bucket_count;   /* number of buckets */
-    size_t size;           /* total number of key-value pairs */
+    HashSlot *slots;
+    size_t capacity;   /* slot count, always a power of two */
+    size_t size;       /* live key-value pairs */
+    size_t used;       /* live + tombstones; drives growth */
 } HashMap;
 
 /* Constructor / Destructor */
@@ -54,7 +60,7 @@ bool hashmap_remove(
     void (*free_value)(void*)
 );
 
-/* Resize / Rehash */
+/* Resize / Rehash (cached hashes make the callbacks optional) */
 bool hashmap_rehash(
     HashMap* map,
     size_t new_bucket_count,
@@ -69,3 +75,44 @@ void hashmap_foreach(
     HashMap* map,
     void (*func)(void* key, void* value)
 );
+
+/* 1 if the slot holds a live entry (for callers iterating map->slots) */
+static inline int hashslot_occupied(const HashSlot *slot) {
+    return slot->hash > 1;
+}
+
+/* -----------------------------
+   Cursor-based iteration
+
+   hashmap_foreach() pays an indirect call per entry and gives the
+   caller no way to early-exit or iterate two tables in lockstep. A
+   cursor walks the slot array linearly and inlines into the caller:
+
+       HashMapIter it;
+       hashmap_iter_init(&it, map);
+       for (HashSlot *s; (s = hashmap_iter_next(&it)); )
+           use(s->key, s->value);
+
+   Insertions or removals during iteration invalidate the cursor.
+   ----------------------------- */
+
+typedef struct {
+    const HashMap *map;
+    size_t index;      /* next slot to examine */
+} HashMapIter;
+
+static inline void hashmap_iter_init(HashMapIter *it, const HashMap *map) {
+    it->map = map;
+    it->index = 0;
+}
+
+/* Next live slot, or NULL when the table is exhausted. */
+static inline HashSlot *hashmap_iter_next(HashMapIter *it) {
+    const HashMap *map = it->map;
+    if (!map) return NULL;
+    while (it->index < map->capacity) {
+        HashSlot *slot = &map->slots[it->index++];
+        if (hashslot_occupied(slot)) return slot;
+    }
+    return NULL;
+}
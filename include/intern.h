@@ -0,0 +1,24 @@
+#pragma once
+#include <stddef.h>
+
+/* Per-thread string interning pool.
+ *
+ * intern_strn() returns one canonical NUL-terminated copy per distinct
+ * string, allocated from the current compile arena, so identifiers that
+ * recur thousands of times (symbol names, hashmap keys, AST identifier
+ * names) share a single pointer: equality becomes a pointer compare and
+ * the hash is a precomputed field stored just before the bytes.
+ *
+ * The pool is thread-local like the current arena, so parallel driver
+ * workers never contend; the driver resets it between compiles.
+ */
+
+const char *intern_strn(const char *s, size_t n);
+const char *intern_str(const char *s);
+
+/* Precomputed hash of an interned pointer (O(1) header read).
+ * Only valid for pointers returned by intern_strn/intern_str. */
+size_t intern_hash(const char *s);
+
+/* Drop the probe table; the strings themselves belong to the arena. */
+void intern_reset(void);
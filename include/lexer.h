@@ -1,16 +1,17 @@
 #pragma once
 
 #include "token.h"
-#include <regex.h>
 
-// Lexer state
+// Lexer state. No per-character line/column bookkeeping: tokens carry
+// only their slice of the source, and positions are derived on demand
+// from a LineIndex when a diagnostic or dump needs them.
 typedef struct {
     const char *src;
+    const char *end;     /* the NUL terminator; bounds bulk scans */
     const char *cursor;
-    int         line;
-    int         column;
 } Lexer;
 
+void     lexer_init_tables(void); /* idempotent table warmup */
 Lexer   *lexer_create(const char *src);
-Token   *lexer_next(Lexer *lx);
+void     lexer_next(Lexer *lx, Token *out); /* always produces a token */
 void     free_lexer(Lexer *lx);
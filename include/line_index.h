@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stddef.h>
+
+/* Line-start offset table over an in-memory source buffer.
+ *
+ * Tokens carry only a pointer into the source; line/column are derived
+ * here on demand (binary search over the table), so error-free compiles
+ * pay nothing for position tracking. The table is built lazily on the
+ * first lookup and the buffer is borrowed, never owned. */
+typedef struct {
+    const char *src;      /* NUL-terminated source buffer (borrowed) */
+    size_t     *offsets;  /* offsets[i] = byte offset of line i+1 */
+    size_t      count;    /* number of lines; 0 until built */
+} LineIndex;
+
+void line_index_init(LineIndex *li, const char *src);
+
+/* Build the table now. Idempotent; locate() calls it on first use. */
+void line_index_build(LineIndex *li);
+
+/* Resolve a position inside the buffer to 1-based line/column.
+ * Writes 0/0 when pos falls outside the buffer (or there is none). */
+void line_index_locate(LineIndex *li, const char *pos,
+                       size_t *line, size_t *col);
+
+void line_index_free(LineIndex *li);
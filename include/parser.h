@@ -1,25 +1,45 @@
 #pragma once
 
 #include "token.h"
+#include "lexer.h"
+#include "line_index.h"
 
 typedef struct {
-    TokenArray tokens;
+    TokenArray tokens;        /* batch: whole stream; streaming: fixed ring */
     size_t      current;
-    size_t      end;          /* index of the last token in the current parse */
+    size_t      end;          /* one past the last token, once it is known */
     char        *filename;
+
+    /* streaming mode (parser_create_streaming): tokens are pulled from
+       the lexer on demand into the ring, fusing lexing and parsing */
+    Lexer      *lx;           /* NULL in batch mode */
+    size_t      ring_base;    /* absolute index of the oldest buffered token */
+    int         saw_eof;
+
+    /* diagnostics: the in-memory source buffer (non-owning) and a lazy
+       line-start index over it; error positions and snippets are only
+       resolved through it when something actually goes wrong */
+    const char *source;
+    LineIndex   li;           /* built on first lookup, parser-owned */
 } Parser;
 
+/* Deferred diagnostic: recording an error stores only the static
+ * message string, the offending token and the parser — nothing is
+ * duplicated and no position is resolved until print_parse_error()
+ * actually renders it, so failed parses cost no allocations. */
 typedef struct {
-    const char *message;      /* error message */
+    const char *message;      /* static string; never owned or freed */
     Token *token;             /* token that caused the error, NULL if not applicable */
-    size_t line;              /* line number of the error */
-    size_t col;               /* column number of the error */
+    size_t line;              /* resolved at print time */
+    size_t col;               /* resolved at print time */
     Parser *p;
-    const char *filename;     /* file where the error occurred */
+    const char *filename;     /* borrowed from the parser at print time */
     int underline_previous_token_line; /* if true, underline the previous token's line instead of the current one */
 } ParseError;
 
-Parser *parser_create(TokenArray tokens, const char *filename);
+Parser *parser_create(TokenArray tokens, const char *filename, const char *source);
+
+Parser *parser_create_streaming(Lexer *lx, const char *filename);
 
 Token *consume(Parser *p, TokenType expected);
 
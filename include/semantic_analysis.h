@@ -2,4 +2,11 @@
 
 #include "scope.h"
 
-int scope_fill_function_declarations(Scope *global_scope, AstProgram *program);
\ No newline at end of file
+int scope_fill_function_declarations(Scope *global_scope, AstProgram *program);
+
+/* Phase two: analyze every function body against the filled global
+ * scope, in parallel across a worker pool (jobs = 0 -> CPU count,
+ * 1 -> inline). Diagnostics are merged to stderr in source order. */
+int semantic_analysis_program(Scope *global_scope, AstProgram *program, size_t jobs);
+
+int semantic_analysis_run(Scope *scope, AstNode *node);
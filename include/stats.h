@@ -0,0 +1,68 @@
+#pragma once
+#include <stddef.h>
+#include <stdio.h>
+
+/* Hot-path statistics counters, reported with --stats.
+ *
+ * Counters are compiled in by default and bumped through the STATS_*
+ * macros so the hot paths stay branch-free; build with
+ * -DCOMPILER_NO_STATS to compile the instrumentation out entirely.
+ * State is thread-local, matching the per-worker arena and intern pool.
+ */
+
+typedef enum {
+    STATS_PHASE_NONE = 0,
+    STATS_PHASE_LOAD,
+    STATS_PHASE_LEX,
+    STATS_PHASE_PARSE,
+    STATS_PHASE_SEM,
+    STATS_PHASE_COUNT
+} StatsPhase;
+
+typedef struct {
+    unsigned long tokens;             /* produced by lexer_next() */
+    unsigned long ast_nodes;          /* created by ast_create_node() */
+    unsigned long hashmap_probes;     /* slots inspected during lookups */
+    unsigned long hashmap_collisions; /* probes past the home slot */
+    unsigned long parser_rewinds;     /* parser_rewind() calls */
+    unsigned long alloc_bytes[STATS_PHASE_COUNT];  /* arena-path bytes per phase */
+    unsigned long xalloc_bytes[STATS_PHASE_COUNT]; /* xmalloc-family bytes per phase */
+    unsigned long xalloc_count[STATS_PHASE_COUNT]; /* xmalloc-family calls per phase */
+} CompilerStats;
+
+#ifdef COMPILER_NO_STATS
+
+#define STATS_INC(field)     ((void)0)
+#define STATS_ADD(field, n)  ((void)0)
+#define STATS_ALLOC(n)       ((void)0)
+#define STATS_XALLOC(n)      ((void)0)
+
+static inline void stats_reset(void) {}
+static inline void stats_set_phase(StatsPhase phase) { (void)phase; }
+static inline void stats_report(FILE *out, const char *filename) {
+    (void)out; (void)filename;
+}
+static inline void stats_report_mem(FILE *out, const char *filename) {
+    (void)out; (void)filename;
+}
+
+#else
+
+extern _Thread_local CompilerStats g_stats;
+extern _Thread_local StatsPhase g_stats_phase;
+
+#define STATS_INC(field)     (g_stats.field++)
+#define STATS_ADD(field, n)  (g_stats.field += (unsigned long)(n))
+#define STATS_ALLOC(n)       (g_stats.alloc_bytes[g_stats_phase] += (unsigned long)(n))
+#define STATS_XALLOC(n)      (g_stats.xalloc_bytes[g_stats_phase] += (unsigned long)(n), \
+                              g_stats.xalloc_count[g_stats_phase]++)
+
+void stats_reset(void);
+void stats_set_phase(StatsPhase phase);
+void stats_report(FILE *out, const char *filename);
+
+/* Memory accounting (--mem-stats): per-phase bytes/counts through the
+ * xmalloc funnel and the arena, plus the process peak RSS. */
+void stats_report_mem(FILE *out, const char *filename);
+
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stddef.h>
+
+/* Growable string builder.
+ *
+ * Tracks its length so an append costs only the bytes appended —
+ * unlike the strncat(buf, ..., size - strlen(buf) - 1) pattern, which
+ * rescans the whole buffer per call and turns deep type/AST printing
+ * quadratic. Capacity doubles on demand, so there is no fixed-size
+ * truncation either. The buffer is always NUL-terminated.
+ */
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t cap;
+} StrBuf;
+
+void strbuf_init(StrBuf *s);
+void strbuf_free(StrBuf *s);
+
+void strbuf_append(StrBuf *s, const char *str);
+void strbuf_append_char(StrBuf *s, char c);
+void strbuf_appendf(StrBuf *s, const char *fmt, ...);
+
+/* Hand the caller the heap buffer (caller frees) and reset s to empty. */
+char *strbuf_detach(StrBuf *s);
@@ -12,9 +12,22 @@ typedef struct {
     int is_const_expr;
 } Symbol;
 
+/* Scopes typically hold a handful of symbols, so tables start as a
+ * small inline array searched linearly (keys are interned, so a probe
+ * is a pointer compare) and promote themselves to the hash map only
+ * once they outgrow it. */
+#define SYMBOL_TABLE_SMALL_CAP 16
+
+typedef struct {
+    char *key;
+    Symbol *value;
+} SymbolSmallEntry;
+
 /* SymbolTable: a typed wrapper around the generic HashMap (string -> Type*) */
 typedef struct {
-    HashMap *table;
+    HashMap *table;          /* NULL while in small (inline array) mode */
+    SymbolSmallEntry small[SYMBOL_TABLE_SMALL_CAP];
+    size_t small_count;
 
     /* ownership helpers (can be replaced after create) */
     void (*free_key)(char*);
@@ -36,6 +49,13 @@ bool symbol_table_put(SymbolTable* table, const char* key, Symbol* value);
 /* Lookup: returns the stored Type* or NULL if not found (does not transfer ownership) */
 Symbol* symbol_table_get(SymbolTable* table, const char* key);
 
+/* Like put/get but storing the caller's own key pointer, without
+ * interning. For tables that outlive the per-compile intern pool
+ * (the process-wide global table): such tables must install
+ * content-based hash/cmp, since keys are not canonicalized. */
+bool symbol_table_put_raw(SymbolTable* table, char* key, Symbol* value);
+Symbol* symbol_table_get_raw(SymbolTable* table, const char* key);
+
 /* Remove: frees key/value using configured free functions */
 bool symbol_table_remove(SymbolTable* table, const char* key);
 
@@ -50,3 +70,55 @@ void symbol_table_foreach(
     SymbolTable* table,
     void (*func)(char* key, Symbol* value)
 );
+
+/* Iterate with a caller context; works in both representations, so
+ * consumers never have to reach into the backing storage. */
+void symbol_table_foreach_ctx(
+    SymbolTable* table,
+    void (*func)(char* key, Symbol* value, void* ctx),
+    void* ctx
+);
+
+/* Cursor-based iteration: no per-entry indirect call, and the caller
+ * keeps control (early exit, local accumulation, lockstep walks over
+ * two tables). Transparent over both representations:
+ *
+ *     SymbolTableIter it;
+ *     symbol_table_iter_init(&it, table);
+ *     char *key; Symbol *sym;
+ *     while (symbol_table_iter_next(&it, &key, &sym))
+ *         use(key, sym);
+ *
+ * Mutating the table during iteration invalidates the cursor. */
+typedef struct {
+    const SymbolTable *table;
+    size_t index;      /* position in the small array */
+    HashMapIter map_it; /* used once the table has promoted */
+} SymbolTableIter;
+
+static inline void symbol_table_iter_init(SymbolTableIter *it,
+                                          const SymbolTable *table) {
+    it->table = table;
+    it->index = 0;
+    hashmap_iter_init(&it->map_it, table ? table->table : NULL);
+}
+
+static inline bool symbol_table_iter_next(SymbolTableIter *it,
+                                          char **key, Symbol **value) {
+    const SymbolTable *table = it->table;
+    if (!table) return false;
+
+    if (!table->table) { /* small (inline array) mode */
+        if (it->index >= table->small_count) return false;
+        *key = table->small[it->index].key;
+        *value = table->small[it->index].value;
+        it->index++;
+        return true;
+    }
+
+    HashSlot *slot = hashmap_iter_next(&it->map_it);
+    if (!slot) return false;
+    *key = (char *)slot->key;
+    *value = (Symbol *)slot->value;
+    return true;
+}
@@ -1,9 +1,10 @@
 #pragma once
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <regex.h>
+#include "line_index.h"
 
 #define X(name, str, regex) name,
 typedef enum {
@@ -12,34 +13,70 @@ typedef enum {
 } TokenType;
 #undef X
 
+/* Tokens carry only a slice into the source buffer; line/column are
+ * derived on demand from a LineIndex when a diagnostic or dump needs
+ * them, so the lexer does no positional bookkeeping per byte. */
 typedef struct {
     TokenType type;
-    const char *lexeme;
-    int line, col;
+    const char *start;  /* non-owning slice into the source buffer */
+    size_t len;
 } Token;
 
 typedef struct {
     TokenType type;
     const char *printable;
-    const char *pattern; // regex
-    regex_t re; // compiled regex, if applicable
+    const char *pattern; // regex-style spec the startup DFA is built from
 } TokenInfo;
 
 extern TokenInfo token_info[NUM_TOKENS];
 
-/* A growable array of Token pointers */
+/* A growable array of Token values: the parser streams through tokens
+ * with sequential cache-line access instead of chasing per-token heap
+ * pointers. */
 typedef struct {
-    Token **data;
+    Token *data;
     size_t size, capacity;
 } TokenArray;
 
-Token *create_token(TokenType type, const char *value, size_t len, int line, int column);
-void   free_token(Token *tok);
+Token  token_make(TokenType type, const char *value, size_t len);
+char  *token_lexeme_dup(const Token *tok);          /* per-call copy of the slice */
+const char *token_lexeme_intern(const Token *tok);   /* canonical interned copy */
 const char *token_type_to_string(TokenType t);
-void   print_token(Token *tok);
-void   print_token_colored(Token *tok);
+void   print_token(const Token *tok, LineIndex *li);
+void   print_token_colored(const Token *tok, LineIndex *li);
 void   token_array_init(TokenArray *arr);
-void   token_array_push(TokenArray *arr, Token *tok);
+void   token_array_push(TokenArray *arr, Token tok);
 void   token_array_free(TokenArray *arr);
-void   dump_tokens_json_fp(FILE *out, Token **tokens, size_t n);
-void   dump_tokens_json_file(const char *filename, Token **tokens, size_t n);
\ No newline at end of file
+/* Dumps resolve positions themselves: source is the buffer the token
+ * slices point into. */
+void   dump_tokens_json_fp(FILE *out, const Token *tokens, size_t n,
+                           const char *source);
+void   dump_tokens_json_file(const char *filename, const Token *tokens, size_t n,
+                             const char *source);
+void   dump_tokens_colored_fp(FILE *out, const Token *tokens, size_t n,
+                              const char *source);
+
+/* Raw binary token stream (--tokens-bin): a TokenBinHeader followed by
+ * one fixed-width TokenBinRecord per token. Offsets are relative to the
+ * source buffer so consumers can slice lexemes out of the original
+ * file without re-lexing. Host endianness. */
+#define TOKEN_BIN_MAGIC   "CTOK"
+#define TOKEN_BIN_VERSION 1u
+
+typedef struct {
+    char     magic[4];
+    uint32_t version;
+    uint64_t count;
+} TokenBinHeader;
+
+typedef struct {
+    uint32_t type;      /* TokenType */
+    uint32_t len;
+    uint64_t offset;    /* byte offset of the lexeme in the source */
+    uint32_t line, col;
+} TokenBinRecord;
+
+void   dump_tokens_bin_fp(FILE *out, const Token *tokens, size_t n,
+                          const char *source_base);
+void   dump_tokens_bin_file(const char *filename, const Token *tokens, size_t n,
+                            const char *source_base);
\ No newline at end of file
@@ -35,6 +35,17 @@ Type *type_make_pointer(Type *to, int is_const);
 Type *type_make_array(Type *of, size_t size, int is_const);
 Type *type_make_function(Type *return_type, Type **params, size_t param_count, int is_const);
 
+/* Constructors hash-cons while a compile arena is installed, so
+ * structurally equal types share one canonical Type* and equality is a
+ * pointer compare. Reset drops the per-thread canonical table; call it
+ * before destroying the arena the types live in. */
+void type_table_reset(void);
+
+/* Deep-copy t into plain heap nodes (names duplicated, no interning
+ * or hash-consing), so the copy outlives the compile arena and
+ * type_free can release it once no arena is installed. */
+Type *type_clone_heap(const Type *t);
+
 void type_print(Type *t);
 void type_print_hierarchical(Type *t);
 void type_print_hierarchical_with_indent(Type *t, int base_indent);
@@ -0,0 +1,123 @@
+#include "arena.h"
+#include "stats.h"
+#include "utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Blocks form a singly-linked chain; allocation bumps a cursor in the
+ * head block and chains a fresh block when it runs out. Oversized
+ * requests get a dedicated block so block_size stays a soft hint. */
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t used;
+    size_t capacity;
+    /* payload follows the header */
+} ArenaBlock;
+
+struct Arena {
+    ArenaBlock *head;
+    size_t block_size;
+};
+
+#define ARENA_ALIGN 16
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+static size_t arena_align_up(size_t n) {
+    return (n + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static ArenaBlock *arena_block_new(size_t capacity) {
+    ArenaBlock *block = xmalloc(sizeof(ArenaBlock) + capacity);
+    block->next = NULL;
+    block->used = 0;
+    block->capacity = capacity;
+    return block;
+}
+
+Arena *arena_create(size_t block_size) {
+    if (block_size == 0) block_size = ARENA_DEFAULT_BLOCK_SIZE;
+    Arena *arena = xmalloc(sizeof(*arena));
+    arena->block_size = block_size;
+    arena->head = arena_block_new(block_size);
+    return arena;
+}
+
+void arena_destroy(Arena *arena) {
+    if (!arena) return;
+    ArenaBlock *block = arena->head;
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
+
+void arena_reset(Arena *arena) {
+    if (!arena) return;
+    for (ArenaBlock *block = arena->head; block; block = block->next) {
+        block->used = 0;
+    }
+}
+
+void *arena_alloc(Arena *arena, size_t n) {
+    n = arena_align_up(n ? n : 1);
+
+    ArenaBlock *block = arena->head;
+    if (block->used + n > block->capacity) {
+        /* oversized requests get their own block, normal ones a fresh
+           standard block chained in front */
+        size_t capacity = n > arena->block_size ? n : arena->block_size;
+        ArenaBlock *fresh = arena_block_new(capacity);
+        fresh->next = arena->head;
+        arena->head = fresh;
+        block = fresh;
+    }
+
+    void *p = (char *)(block + 1) + block->used;
+    block->used += n;
+    return p;
+}
+
+/* -----------------------
+ * current compile arena
+ * --------------------- */
+
+/* Per-thread so parallel driver workers each install their own arena. */
+static _Thread_local Arena *g_current_arena = NULL;
+
+void arena_set_current(Arena *arena) {
+    g_current_arena = arena;
+}
+
+Arena *arena_current(void) {
+    return g_current_arena;
+}
+
+int arena_active(void) {
+    return g_current_arena != NULL;
+}
+
+void *arena_alloc_current(size_t n) {
+    STATS_ALLOC(n);
+    if (g_current_arena) return arena_alloc(g_current_arena, n);
+    return xmalloc(n);
+}
+
+char *arena_strdup_current(const char *s) {
+    if (!s) return NULL;
+    size_t len = strlen(s);
+    char *d = arena_alloc_current(len + 1);
+    memcpy(d, s, len + 1);
+    return d;
+}
+
+char *arena_strndup_current(const char *s, size_t n) {
+    if (!s) return NULL;
+    size_t len = strnlen(s, n);
+    char *d = arena_alloc_current(len + 1);
+    memcpy(d, s, len);
+    d[len] = '\0';
+    return d;
+}
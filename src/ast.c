@@ -1,5 +1,9 @@
 #include "ast.h"
 #include "token.h"
+#include "arena.h"
+#include "stats.h"
+#include "strbuf.h"
+#include "utils.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -7,218 +11,147 @@
 #include "ast_dyn_node_array.h"
 
 /* Forward declarations */
-static void format_type_compact(AstNode *type_node, char *buffer, size_t buffer_size);
-static void format_expression_compact(AstNode *expr_node, char *buffer, size_t buffer_size);
-
+static void format_type_compact(AstNode *type_node, StrBuf *sb);
+static void format_expression_compact(AstNode *expr_node, StrBuf *sb);
+
+
+/* Payload byte count per node kind. Nodes are allocated at header +
+ * payload size rather than the full union, so an AST_LITERAL does not
+ * pay for the largest variant (AstType); code must therefore only ever
+ * touch the union member matching node_type, which the parser already
+ * guarantees. */
+static const size_t ast_payload_sizes[] = {
+    [AST_PROGRAM]              = sizeof(AstProgram),
+    [AST_VARIABLE_DECLARATION] = sizeof(AstVariableDeclaration),
+    [AST_FUNCTION_DECLARATION] = sizeof(AstFunctionDeclaration),
+    [AST_PARAM]                = sizeof(AstParam),
+    [AST_BLOCK]                = sizeof(AstBlock),
+    [AST_IF_STATEMENT]         = sizeof(AstIfStatement),
+    [AST_WHILE_STATEMENT]      = sizeof(AstWhileStatement),
+    [AST_FOR_STATEMENT]        = sizeof(AstForStatement),
+    [AST_RETURN_STATEMENT]     = sizeof(AstReturnStatement),
+    [AST_BREAK_STATEMENT]      = sizeof(AstBreakStatement),
+    [AST_CONTINUE_STATEMENT]   = sizeof(AstContinueStatement),
+    [AST_EXPR_STATEMENT]       = sizeof(AstExprStatement),
+    [AST_LITERAL]              = sizeof(AstLiteral),
+    [AST_IDENTIFIER]           = sizeof(AstIdentifier),
+    [AST_BINARY_EXPR]          = sizeof(AstBinaryExpr),
+    [AST_UNARY_EXPR]           = sizeof(AstUnaryExpr),
+    [AST_POSTFIX_EXPR]         = sizeof(AstPostfixExpr),
+    [AST_ASSIGNMENT_EXPR]      = sizeof(AstAssignmentExpr),
+    [AST_CALL_EXPR]            = sizeof(AstCallExpr),
+    [AST_SUBSCRIPT_EXPR]       = sizeof(AstSubscriptExpr),
+    [AST_TYPE]                 = sizeof(AstType),
+    [AST_INITIALIZER_LIST]     = sizeof(AstInitializeList),
+};
 
 AstNode *ast_create_node(AstNodeType type)
 {
-    AstNode *node = malloc(sizeof(*node));
-    if (!node) {
-        perror("malloc");
-        exit(EXIT_FAILURE);
-    }
+    /* header (24 bytes) + just the payload this kind needs: every kind
+     * except AST_TYPE then fits in a single cache line */
+    size_t size = offsetof(AstNode, data) + ast_payload_sizes[type];
+    AstNode *node = arena_alloc_current(size);
+    STATS_INC(ast_nodes);
 
-    /* Zero entire node (including union and metadata fields) */
-    memset(node, 0, sizeof(*node));
+    /* Zero the allocated prefix (metadata and this kind's payload) */
+    memset(node, 0, size);
 
     node->node_type = type;
-    /* explicit defaults (redundant due to memset, but clearer) */
-    node->is_const_expr = 0;
-    node->sem_type = NULL;
-    node->const_value = NULL;
 
     return node;
 }
 
 
 
-/* Helper: format a type compactly into a string buffer */
-static void format_type_compact(AstNode *type_node, char *buffer, size_t buffer_size) {
-    if (!type_node || !buffer || buffer_size == 0) {
-        if (buffer && buffer_size > 0) buffer[0] = '\0';
-        return;
+/* Append a type's stars and array dimensions (shared by every shape). */
+static void format_type_suffix(const AstType *t, StrBuf *sb) {
+    for (size_t i = 0; i < t->pre_stars; ++i)
+        strbuf_append_char(sb, '*');
+
+    if (t->sizes) {
+        size_t n = astnode_array_count(t->sizes);
+        for (size_t i = 0; i < n; ++i) {
+            AstNode *dim = astnode_array_get(t->sizes, i);
+            strbuf_append_char(sb, '[');
+            if (dim) format_expression_compact(dim, sb);
+            strbuf_append_char(sb, ']');
+        }
     }
-    
-    buffer[0] = '\0';
-    
+
+    for (size_t i = 0; i < t->post_stars; ++i)
+        strbuf_append_char(sb, '*');
+}
+
+/* Helper: append a type's compact spelling to the builder. Appends
+ * cost only the bytes added, so deep pointer/function types stay
+ * linear and nothing truncates. */
+static void format_type_compact(AstNode *type_node, StrBuf *sb) {
+    if (!type_node) return;
+
+    const AstType *t = &type_node->data.ast_type;
+
     // Handle parenthesized/grouped types (inner type stored in return_type, no base_type or is_function)
-    if (!type_node->data.ast_type.is_function && !type_node->data.ast_type.base_type && type_node->data.ast_type.return_type) {
-        // Add const qualifier for grouped types
-        if (type_node->data.ast_type.base_is_const) {
-            strncat(buffer, "const ", buffer_size - strlen(buffer) - 1);
-        }
-        
-        // This is a parenthesized type - format the inner type with parentheses
-        strncat(buffer, "(", buffer_size - strlen(buffer) - 1);
-        char inner_buffer[256];
-        format_type_compact(type_node->data.ast_type.return_type, inner_buffer, sizeof(inner_buffer));
-        strncat(buffer, inner_buffer, buffer_size - strlen(buffer) - 1);
-        strncat(buffer, ")", buffer_size - strlen(buffer) - 1);
-        
-        // Add pre-stars
-        for (size_t i = 0; i < type_node->data.ast_type.pre_stars; ++i) {
-            strncat(buffer, "*", buffer_size - strlen(buffer) - 1);
-        }
-        
-        // Add array dimensions
-        if (type_node->data.ast_type.sizes) {
-            size_t n = astnode_array_count(type_node->data.ast_type.sizes);
-            for (size_t i = 0; i < n; ++i) {
-                AstNode *dim = astnode_array_get(type_node->data.ast_type.sizes, i);
-                strncat(buffer, "[", buffer_size - strlen(buffer) - 1);
-                if (dim) {
-                    // Format the dimension expression into a string
-                    char dim_buffer[128];
-                    format_expression_compact(dim, dim_buffer, sizeof(dim_buffer));
-                    strncat(buffer, dim_buffer, buffer_size - strlen(buffer) - 1);
-                }
-                strncat(buffer, "]", buffer_size - strlen(buffer) - 1);
-            }
-        }
-        
-        // Add post-stars
-        for (size_t i = 0; i < type_node->data.ast_type.post_stars; ++i) {
-            strncat(buffer, "*", buffer_size - strlen(buffer) - 1);
-        }
+    if (!t->is_function && !t->base_type && t->return_type) {
+        if (t->base_is_const) strbuf_append(sb, "const ");
+
+        strbuf_append_char(sb, '(');
+        format_type_compact(t->return_type, sb);
+        strbuf_append_char(sb, ')');
+
+        format_type_suffix(t, sb);
     }
     // Handle function types
-    else if (type_node->data.ast_type.is_function) {
+    else if (t->is_function) {
         // For function types, put const before the parameter list
-        if (type_node->data.ast_type.base_is_const) {
-            strncat(buffer, "const ", buffer_size - strlen(buffer) - 1);
-        }
-        
-        strncat(buffer, "fn(", buffer_size - strlen(buffer) - 1);
-        
-        // Add parameter types (without const, since const applies to the function)
-        if (type_node->data.ast_type.param_types) {
-            size_t param_count = astnode_array_count(type_node->data.ast_type.param_types);
+        if (t->base_is_const) strbuf_append(sb, "const ");
+
+        strbuf_append(sb, "fn(");
+
+        // Parameter types (without const, since const applies to the function)
+        if (t->param_types) {
+            size_t param_count = astnode_array_count(t->param_types);
             for (size_t i = 0; i < param_count; ++i) {
-                if (i > 0) strncat(buffer, ", ", buffer_size - strlen(buffer) - 1);
-                
-                AstNode *param_type = astnode_array_get(type_node->data.ast_type.param_types, i);
-                if (param_type) {
-                    char param_buffer[256];
-                    format_type_compact(param_type, param_buffer, sizeof(param_buffer));
-                    strncat(buffer, param_buffer, buffer_size - strlen(buffer) - 1);
-                } else {
-                    strncat(buffer, "?", buffer_size - strlen(buffer) - 1);
-                }
-            }
-        }
-        
-        strncat(buffer, ")", buffer_size - strlen(buffer) - 1);
-        
-        // Add return type
-        if (type_node->data.ast_type.return_type) {
-            strncat(buffer, " -> ", buffer_size - strlen(buffer) - 1);
-            char return_buffer[256];
-            format_type_compact(type_node->data.ast_type.return_type, return_buffer, sizeof(return_buffer));
-            strncat(buffer, return_buffer, buffer_size - strlen(buffer) - 1);
-        }
-        
-        // Add array dimensions and stars for function types too!
-        // Add pre-stars
-        for (size_t i = 0; i < type_node->data.ast_type.pre_stars; ++i) {
-            strncat(buffer, "*", buffer_size - strlen(buffer) - 1);
-        }
-        
-        // Add array dimensions
-        if (type_node->data.ast_type.sizes) {
-            size_t n = astnode_array_count(type_node->data.ast_type.sizes);
-            for (size_t i = 0; i < n; ++i) {
-                AstNode *dim = astnode_array_get(type_node->data.ast_type.sizes, i);
-                strncat(buffer, "[", buffer_size - strlen(buffer) - 1);
-                if (dim) {
-                    // Format the dimension expression into a string
-                    char dim_buffer[128];
-                    format_expression_compact(dim, dim_buffer, sizeof(dim_buffer));
-                    strncat(buffer, dim_buffer, buffer_size - strlen(buffer) - 1);
-                }
-                strncat(buffer, "]", buffer_size - strlen(buffer) - 1);
+                if (i > 0) strbuf_append(sb, ", ");
+
+                AstNode *param_type = astnode_array_get(t->param_types, i);
+                if (param_type) format_type_compact(param_type, sb);
+                else strbuf_append_char(sb, '?');
             }
         }
-        
-        // Add post-stars
-        for (size_t i = 0; i < type_node->data.ast_type.post_stars; ++i) {
-            strncat(buffer, "*", buffer_size - strlen(buffer) - 1);
+
+        strbuf_append_char(sb, ')');
+
+        if (t->return_type) {
+            strbuf_append(sb, " -> ");
+            format_type_compact(t->return_type, sb);
         }
+
+        format_type_suffix(t, sb);
     } else {
         // Regular type
-        // Add const qualifier for regular types
-        if (type_node->data.ast_type.base_is_const) {
-            strncat(buffer, "const ", buffer_size - strlen(buffer) - 1);
-        }
-        
-        const char *base = type_node->data.ast_type.base_type ? type_node->data.ast_type.base_type : "?";
-        strncat(buffer, base, buffer_size - strlen(buffer) - 1);
-        
-        // Add pre-stars
-        for (size_t i = 0; i < type_node->data.ast_type.pre_stars; ++i) {
-            strncat(buffer, "*", buffer_size - strlen(buffer) - 1);
-        }
-        
-        // Add array dimensions
-        if (type_node->data.ast_type.sizes) {
-            size_t n = astnode_array_count(type_node->data.ast_type.sizes);
-            for (size_t i = 0; i < n; ++i) {
-                AstNode *dim = astnode_array_get(type_node->data.ast_type.sizes, i);
-                strncat(buffer, "[", buffer_size - strlen(buffer) - 1);
-                if (dim) {
-                    // Format the dimension expression into a string
-                    char dim_buffer[128];
-                    format_expression_compact(dim, dim_buffer, sizeof(dim_buffer));
-                    strncat(buffer, dim_buffer, buffer_size - strlen(buffer) - 1);
-                }
-                strncat(buffer, "]", buffer_size - strlen(buffer) - 1);
-            }
-        }
-        
-        // Add post-stars
-        for (size_t i = 0; i < type_node->data.ast_type.post_stars; ++i) {
-            strncat(buffer, "*", buffer_size - strlen(buffer) - 1);
-        }
+        if (t->base_is_const) strbuf_append(sb, "const ");
+        strbuf_append(sb, t->base_type ? t->base_type : "?");
+
+        format_type_suffix(t, sb);
     }
 }
 
-/* Helper: format an expression compactly into a string buffer */
-static void format_expression_compact(AstNode *expr_node, char *buffer, size_t buffer_size) {
-    if (!expr_node || !buffer || buffer_size == 0) {
-        if (buffer && buffer_size > 0) buffer[0] = '\0';
-        return;
-    }
-    
-    buffer[0] = '\0';
-    
+/* Helper: append an expression's compact spelling to the builder. */
+static void format_expression_compact(AstNode *expr_node, StrBuf *sb) {
+    if (!expr_node) return;
+
     switch (expr_node->node_type) {
         case AST_LITERAL:
-            if (expr_node->data.literal.value) {
-                strncat(buffer, expr_node->data.literal.value, buffer_size - strlen(buffer) - 1);
-            } else {
-                strncat(buffer, "?", buffer_size - strlen(buffer) - 1);
-            }
+            strbuf_append(sb, expr_node->data.literal.value
+                              ? expr_node->data.literal.value : "?");
             break;
-            
+
         case AST_IDENTIFIER:
-            if (expr_node->data.identifier.identifier) {
-                strncat(buffer, expr_node->data.identifier.identifier, buffer_size - strlen(buffer) - 1);
-            } else {
-                strncat(buffer, "?", buffer_size - strlen(buffer) - 1);
-            }
+            strbuf_append(sb, expr_node->data.identifier.identifier
+                              ? expr_node->data.identifier.identifier : "?");
             break;
-            
+
         case AST_BINARY_EXPR: {
-            char left_buf[64] = {0};
-            char right_buf[64] = {0};
-            
-            if (expr_node->data.binary_expr.left) {
-                format_expression_compact(expr_node->data.binary_expr.left, left_buf, sizeof(left_buf));
-            }
-            if (expr_node->data.binary_expr.right) {
-                format_expression_compact(expr_node->data.binary_expr.right, right_buf, sizeof(right_buf));
-            }
-            
             const char *op_str = "?";
             switch (expr_node->data.binary_expr.op) {
                 case OP_ADD: op_str = " + "; break;
@@ -228,17 +161,14 @@ static void format_expression_compact(AstNode *expr_node, char *buffer, size_t b
                 case OP_MOD: op_str = " % "; break;
                 default: break;
             }
-            
-            snprintf(buffer, buffer_size, "%s%s%s", left_buf, op_str, right_buf);
+
+            format_expression_compact(expr_node->data.binary_expr.left, sb);
+            strbuf_append(sb, op_str);
+            format_expression_compact(expr_node->data.binary_expr.right, sb);
             break;
         }
-        
+
         case AST_UNARY_EXPR: {
-            char expr_buf[64] = {0};
-            if (expr_node->data.unary_expr.expr) {
-                format_expression_compact(expr_node->data.unary_expr.expr, expr_buf, sizeof(expr_buf));
-            }
-            
             const char *op_str = "?";
             switch (expr_node->data.unary_expr.op) {
                 case OP_ADD: op_str = "+"; break;  // unary plus
@@ -246,13 +176,14 @@ static void format_expression_compact(AstNode *expr_node, char *buffer, size_t b
                 case OP_NOT: op_str = "!"; break;
                 default: break;
             }
-            
-            snprintf(buffer, buffer_size, "%s%s", op_str, expr_buf);
+
+            strbuf_append(sb, op_str);
+            format_expression_compact(expr_node->data.unary_expr.expr, sb);
             break;
         }
-        
+
         default:
-            strncat(buffer, "?", buffer_size - strlen(buffer) - 1);
+            strbuf_append_char(sb, '?');
             break;
     }
 }
@@ -266,176 +197,231 @@ static void free_node_array(AstNode **arr, size_t count) {
     free(arr);
 }
 
-/* Main recursive free function */
-void ast_node_free(AstNode *node) {
-    if (!node) return;
-
-    /* Free the union data based on node type */
-    if (node->const_value) {
-        free(node->const_value);
-    }
-
-    if (node->sem_type) type_free(node->sem_type);
-
-    switch (node->node_type) {
-        case AST_PROGRAM:
-            if (node->data.program.decls) {
-                astnode_array_free(node->data.program.decls);
-                free(node->data.program.decls);
-            }
-            break;
-
-        case AST_VARIABLE_DECLARATION:
-            if (node->data.variable_declaration.type)
-                ast_node_free(node->data.variable_declaration.type);
-            free(node->data.variable_declaration.name);
-            if (node->data.variable_declaration.initializer)
-                ast_node_free(node->data.variable_declaration.initializer);
-            break;
-
-        case AST_FUNCTION_DECLARATION:
-            if (node->data.function_declaration.return_type)
-                ast_node_free(node->data.function_declaration.return_type);
-            free(node->data.function_declaration.name);
-            /* params are AstNode* (AST_PARAM nodes) */
-            if (node->data.function_declaration.params) {
-                astnode_array_free(node->data.function_declaration.params);
-                free(node->data.function_declaration.params);
-            }
-            if (node->data.function_declaration.body)
-                ast_node_free(node->data.function_declaration.body);
-            break;
-
-        case AST_PARAM:
-            free(node->data.param.name);
-            if (node->data.param.type)
-                ast_node_free(node->data.param.type);
-            break;
-
-        case AST_BLOCK:
-            if (node->data.block.statements) {
-                astnode_array_free(node->data.block.statements);
-                free(node->data.block.statements);
-            }
-            break;
-
-        case AST_IF_STATEMENT:
-            if (node->data.if_statement.condition)
-                ast_node_free(node->data.if_statement.condition);
-            if (node->data.if_statement.then_branch)
-                ast_node_free(node->data.if_statement.then_branch);
-            if (node->data.if_statement.else_branch)
-                ast_node_free(node->data.if_statement.else_branch);
-            break;
-
-        case AST_WHILE_STATEMENT:
-            if (node->data.while_statement.condition)
-                ast_node_free(node->data.while_statement.condition);
-            if (node->data.while_statement.body)
-                ast_node_free(node->data.while_statement.body);
-            break;
-
-        case AST_FOR_STATEMENT:
-            if (node->data.for_statement.init)
-                ast_node_free(node->data.for_statement.init);
-            if (node->data.for_statement.condition)
-                ast_node_free(node->data.for_statement.condition);
-            if (node->data.for_statement.post)
-                ast_node_free(node->data.for_statement.post);
-            if (node->data.for_statement.body)
-                ast_node_free(node->data.for_statement.body);
-            break;
-
-        case AST_RETURN_STATEMENT:
-            if (node->data.return_statement.expression)
-                ast_node_free(node->data.return_statement.expression);
-            break;
-
-        case AST_BREAK_STATEMENT:
-        case AST_CONTINUE_STATEMENT:
-            /* nothing inside */
-            break;
-
-        case AST_EXPR_STATEMENT:
-            if (node->data.expr_statement.expression)
-                ast_node_free(node->data.expr_statement.expression);
-            break;
+/* Free memory owned by a node unless it came from the compile arena
+ * (arena memory is released wholesale by arena_destroy). */
+static void node_free_owned(void *p) {
+    if (p && !arena_active()) free(p);
+}
 
-        /* Expressions */
-        case AST_LITERAL:
-            free(node->data.literal.value);
-            break;
+/* ---------------------------------------------------------------
+ * Iterative traversal engine
+ *
+ * Deeply nested sources blow the C stack if tree walks recurse — the
+ * left-assoc binary chains in the parser happily build 100k-deep
+ * expression spines — so the passes below drive an explicit work
+ * stack instead. One item is either a node to visit or, for the
+ * printer, a pending piece of output; pushing a node's children in
+ * reverse keeps the visit order identical to the old recursive code.
+ * --------------------------------------------------------------- */
+
+enum {
+    WALK_NODE,   /* visit node */
+    WALK_TEXT,   /* printer: indent + label line */
+    WALK_FMT,    /* printer: indent + printf(label, aux) */
+    WALK_PARAM   /* printer: function-parameter entry */
+};
+
+typedef struct {
+    AstNode *node;
+    const char *label;
+    size_t aux;
+    int indent;
+    unsigned char tag;
+} WalkItem;
+
+#define WALK_INLINE_CAP 64
+
+typedef struct {
+    WalkItem *items;
+    size_t count, cap;
+    WalkItem inline_items[WALK_INLINE_CAP]; /* shallow trees never malloc */
+} WalkStack;
+
+static void walk_init(WalkStack *w) {
+    w->items = w->inline_items;
+    w->count = 0;
+    w->cap = WALK_INLINE_CAP;
+}
 
-        case AST_IDENTIFIER:
-            free(node->data.identifier.identifier);
-            break;
+static void walk_dispose(WalkStack *w) {
+    if (w->items != w->inline_items) free(w->items);
+}
 
-        case AST_BINARY_EXPR:
-            if (node->data.binary_expr.left)
-                ast_node_free(node->data.binary_expr.left);
-            if (node->data.binary_expr.right)
-                ast_node_free(node->data.binary_expr.right);
-            break;
+static void walk_push_item(WalkStack *w, WalkItem item) {
+    if (w->count == w->cap) {
+        size_t new_cap = w->cap * 2;
+        if (w->items == w->inline_items) {
+            w->items = xmalloc(new_cap * sizeof *w->items);
+            memcpy(w->items, w->inline_items, w->count * sizeof *w->items);
+        } else {
+            w->items = xrealloc(w->items, new_cap * sizeof *w->items);
+        }
+        w->cap = new_cap;
+    }
+    w->items[w->count++] = item;
+}
 
-        case AST_UNARY_EXPR:
-            if (node->data.unary_expr.expr)
-                ast_node_free(node->data.unary_expr.expr);
-            break;
+static void walk_push_node(WalkStack *w, AstNode *node, int indent) {
+    WalkItem it = { node, NULL, 0, indent, WALK_NODE };
+    walk_push_item(w, it);
+}
 
-        case AST_POSTFIX_EXPR:
-            if (node->data.postfix_expr.expr)
-                ast_node_free(node->data.postfix_expr.expr);
-            /* postfix op is an enum value only; nothing else to free */
-            break;
+static void walk_push_text(WalkStack *w, const char *label, int indent) {
+    WalkItem it = { NULL, label, 0, indent, WALK_TEXT };
+    walk_push_item(w, it);
+}
 
-        case AST_ASSIGNMENT_EXPR:
-            if (node->data.assignment_expr.lvalue)
-                ast_node_free(node->data.assignment_expr.lvalue);
-            if (node->data.assignment_expr.rvalue)
-                ast_node_free(node->data.assignment_expr.rvalue);
-            break;
+static void walk_push_fmt(WalkStack *w, const char *fmt, size_t aux, int indent) {
+    WalkItem it = { NULL, fmt, aux, indent, WALK_FMT };
+    walk_push_item(w, it);
+}
 
-        case AST_CALL_EXPR:
-            if (node->data.call_expr.callee)
-                ast_node_free(node->data.call_expr.callee);
-            if (node->data.call_expr.args) {
-                astnode_array_free(node->data.call_expr.args);
-                free(node->data.call_expr.args);
-            }
-            break;
+static void walk_push_param(WalkStack *w, AstNode *param, int indent) {
+    WalkItem it = { param, NULL, 0, indent, WALK_PARAM };
+    walk_push_item(w, it);
+}
 
-        case AST_SUBSCRIPT_EXPR:
-            if (node->data.subscript_expr.target)
-                ast_node_free(node->data.subscript_expr.target);
-            if (node->data.subscript_expr.index)
-                ast_node_free(node->data.subscript_expr.index);
-            break;
+/* Queue an array's elements for freeing and release its backing
+ * storage; the elements themselves are freed as they are popped. */
+static void walk_free_array(WalkStack *w, AstNodeArray *arr) {
+    if (!arr) return;
+    size_t n = astnode_array_count(arr);
+    for (size_t i = 0; i < n; ++i)
+        walk_push_node(w, astnode_array_get(arr, i), 0);
+    astnode_array_dispose(arr);
+    node_free_owned(arr);
+}
 
-        case AST_TYPE:
-            free(node->data.ast_type.base_type);
-            if (node->data.ast_type.sizes) {
-                astnode_array_free(node->data.ast_type.sizes);
-                free(node->data.ast_type.sizes);
-            }
-            if (node->data.ast_type.param_types) {
-                astnode_array_free(node->data.ast_type.param_types);
-                free(node->data.ast_type.param_types);
-            }
-            break;
-        
-        case AST_INITIALIZER_LIST:
-            if (node->data.initializer_list.elements) {
-                astnode_array_free(node->data.initializer_list.elements);
-                free(node->data.initializer_list.elements);
-            }
-            break;
+/* Free a whole subtree. Iterative: each popped node releases what it
+ * owns and queues its children, so depth costs heap, not C stack. */
+void ast_node_free(AstNode *node) {
+    if (!node) return;
 
-        default:
-            /* unknown node kind: nothing special to free */
-            break;
+    WalkStack w;
+    walk_init(&w);
+    walk_push_node(&w, node, 0);
+
+    while (w.count) {
+        AstNode *n = w.items[--w.count].node;
+        if (!n) continue;
+
+        if (n->const_value) {
+            node_free_owned(n->const_value);
+        }
+
+        if (n->sem_type) type_free(n->sem_type);
+
+        switch (n->node_type) {
+            case AST_PROGRAM:
+                walk_free_array(&w, n->data.program.decls);
+                break;
+
+            case AST_VARIABLE_DECLARATION:
+                walk_push_node(&w, n->data.variable_declaration.type, 0);
+                walk_push_node(&w, n->data.variable_declaration.initializer, 0);
+                break;
+
+            case AST_FUNCTION_DECLARATION:
+                walk_push_node(&w, n->data.function_declaration.return_type, 0);
+                /* params are AstNode* (AST_PARAM nodes) */
+                walk_free_array(&w, n->data.function_declaration.params);
+                walk_push_node(&w, n->data.function_declaration.body, 0);
+                break;
+
+            case AST_PARAM:
+                walk_push_node(&w, n->data.param.type, 0);
+                break;
+
+            case AST_BLOCK:
+                walk_free_array(&w, n->data.block.statements);
+                break;
+
+            case AST_IF_STATEMENT:
+                walk_push_node(&w, n->data.if_statement.condition, 0);
+                walk_push_node(&w, n->data.if_statement.then_branch, 0);
+                walk_push_node(&w, n->data.if_statement.else_branch, 0);
+                break;
+
+            case AST_WHILE_STATEMENT:
+                walk_push_node(&w, n->data.while_statement.condition, 0);
+                walk_push_node(&w, n->data.while_statement.body, 0);
+                break;
+
+            case AST_FOR_STATEMENT:
+                walk_push_node(&w, n->data.for_statement.init, 0);
+                walk_push_node(&w, n->data.for_statement.condition, 0);
+                walk_push_node(&w, n->data.for_statement.post, 0);
+                walk_push_node(&w, n->data.for_statement.body, 0);
+                break;
+
+            case AST_RETURN_STATEMENT:
+                walk_push_node(&w, n->data.return_statement.expression, 0);
+                break;
+
+            case AST_BREAK_STATEMENT:
+            case AST_CONTINUE_STATEMENT:
+                /* nothing inside */
+                break;
+
+            case AST_EXPR_STATEMENT:
+                walk_push_node(&w, n->data.expr_statement.expression, 0);
+                break;
+
+            /* Expressions */
+            case AST_LITERAL:
+                node_free_owned(n->data.literal.value);
+                break;
+
+            case AST_IDENTIFIER:
+                break;
+
+            case AST_BINARY_EXPR:
+                walk_push_node(&w, n->data.binary_expr.left, 0);
+                walk_push_node(&w, n->data.binary_expr.right, 0);
+                break;
+
+            case AST_UNARY_EXPR:
+                walk_push_node(&w, n->data.unary_expr.expr, 0);
+                break;
+
+            case AST_POSTFIX_EXPR:
+                walk_push_node(&w, n->data.postfix_expr.expr, 0);
+                /* postfix op is an enum value only; nothing else to free */
+                break;
+
+            case AST_ASSIGNMENT_EXPR:
+                walk_push_node(&w, n->data.assignment_expr.lvalue, 0);
+                walk_push_node(&w, n->data.assignment_expr.rvalue, 0);
+                break;
+
+            case AST_CALL_EXPR:
+                walk_push_node(&w, n->data.call_expr.callee, 0);
+                walk_free_array(&w, n->data.call_expr.args);
+                break;
+
+            case AST_SUBSCRIPT_EXPR:
+                walk_push_node(&w, n->data.subscript_expr.target, 0);
+                walk_push_node(&w, n->data.subscript_expr.index, 0);
+                break;
+
+            case AST_TYPE:
+                walk_free_array(&w, n->data.ast_type.sizes);
+                walk_free_array(&w, n->data.ast_type.param_types);
+                break;
+
+            case AST_INITIALIZER_LIST:
+                walk_free_array(&w, n->data.initializer_list.elements);
+                break;
+
+            default:
+                /* unknown node kind: nothing special to free */
+                break;
+        }
+
+        node_free_owned(n);
     }
 
-    free(node);
+    walk_dispose(&w);
 }
 
 
@@ -545,421 +531,401 @@ static const char *opkind_to_string(OpKind op) {
     }
 }
 
-/* print function parameters (AstParam) */
-/* print function parameters (AstParam) -- dynarray version */
-static void print_params(AstNodeArray *params, int indent) {
-    print_indent(indent);
-    printf("Parameters:\n");
-    size_t n = astnode_array_count(params);
-    for (size_t i = 0; i < n; ++i) {
-        AstNode *p = astnode_array_get(params, i);
-        if (!p) continue;
-        print_indent(indent + 1);
-        printf("Param: %s", p->data.param.name ? p->data.param.name : "(anon)");
-        if (p->data.param.type) {
-            printf("\n");
-            /* Print type node inline if available (simple) */
-            print_ast(p->data.param.type, indent + 2);
-        }
-    }
-}
-
-
-/* print argument list (call) */
-static void print_call_args(AstNodeArray *args, int indent) {
-    print_indent(indent);
-    printf("Args:\n");
-    size_t n = astnode_array_count(args);
-    for (size_t i = 0; i < n; ++i) {
-        
-        AstNode *arg = astnode_array_get(args, i);
-        if (!arg) continue;
-        print_ast(arg, indent + 1);
-    }
-}
+/* main printer. Iterative: a popped WALK_NODE prints its own header
+ * lines immediately and pushes its children (and any section labels)
+ * in reverse, so the output is identical to the old recursive walk
+ * while arbitrarily deep trees use constant C stack. */
+void print_ast(AstNode *node, int indent) {
+    WalkStack w;
+    walk_init(&w);
+    walk_push_node(&w, node, indent);
 
+    while (w.count) {
+        WalkItem it = w.items[--w.count];
+        int ind = it.indent;
 
-/* main printer */
-void print_ast(AstNode *node, int indent) {
-    if (!node) {
-        print_indent(indent);
-        printf("(null)\n");
-        return;
-    }
+        if (it.tag == WALK_TEXT) {
+            print_indent(ind);
+            printf("%s\n", it.label);
+            continue;
+        }
 
-    switch (node->node_type) {
-        case AST_PROGRAM: {
-            print_indent(indent);
-            printf("Program:\n");
-
-            if (node->data.program.decls) {
-                size_t n = astnode_array_count(node->data.program.decls);
-                for (size_t i = 0; i < n; ++i) {
-                    AstNode *child = astnode_array_get(node->data.program.decls, i);
-                    print_ast(child, indent + 1);
-                }
-            }
-            break;
-        }           
-
-        case AST_VARIABLE_DECLARATION: {
-            print_indent(indent);
-            printf("Declaration:\n");
-            print_indent(indent + 1);
-            printf("Variable: %s\n", node->data.variable_declaration.name ? node->data.variable_declaration.name : "(anon)");
-            if (node->data.variable_declaration.type) {
-                print_ast(node->data.variable_declaration.type, indent + 2);
-            }
-            if (node->data.variable_declaration.initializer) {
-                print_indent(indent + 2);
-                printf("Initializer:\n");
-                print_ast(node->data.variable_declaration.initializer, indent + 3);
-            }
-            break;
+        if (it.tag == WALK_FMT) {
+            print_indent(ind);
+            printf(it.label, it.aux);
+            continue;
         }
 
-        case AST_FUNCTION_DECLARATION: {
-            print_indent(indent);
-            printf("Function: %s\n", node->data.function_declaration.name ? node->data.function_declaration.name : "(anon)");
-            if (node->data.function_declaration.return_type) {
-                print_indent(indent + 1);
-                printf("ReturnType:\n");
-                print_ast(node->data.function_declaration.return_type, indent + 2);
-            }
-        
-            /* use dynarray for params now */
-            if (node->data.function_declaration.params && astnode_array_count(node->data.function_declaration.params) > 0) {
-                print_params(node->data.function_declaration.params, indent + 1);
-            } else {
-                print_indent(indent + 1);
-                printf("Parameters: (none)\n");
-            }
-        
-            if (node->data.function_declaration.body) {
-                print_indent(indent + 1);
-                printf("Body:\n");
-                print_ast(node->data.function_declaration.body, indent + 2);
+        if (it.tag == WALK_PARAM) {
+            /* function-parameter entry: inline name, type below */
+            AstNode *p = it.node;
+            print_indent(ind);
+            printf("Param: %s", p->data.param.name ? p->data.param.name : "(anon)");
+            if (p->data.param.type) {
+                printf("\n");
+                walk_push_node(&w, p->data.param.type, ind + 1);
             }
-            break;
+            continue;
         }
 
-        case AST_PARAM: {
-            print_indent(indent);
-            printf("Param: %s\n", node->data.param.name ? node->data.param.name : "(anon)");
-            if (node->data.param.type) {
-                print_ast(node->data.param.type, indent + 1);
-            }
-            break;
+        AstNode *n = it.node;
+        if (!n) {
+            print_indent(ind);
+            printf("(null)\n");
+            continue;
         }
 
-        case AST_BLOCK: {
-            print_indent(indent);
-            printf("Block:\n");
-            if (node->data.block.statements) {
-                size_t n = astnode_array_count(node->data.block.statements);
-                for (size_t i = 0; i < n; ++i) {
-                    AstNode *stmt = astnode_array_get(node->data.block.statements, i);
-                    print_ast(stmt, indent + 1);
+        switch (n->node_type) {
+            case AST_PROGRAM: {
+                print_indent(ind);
+                printf("Program:\n");
+
+                if (n->data.program.decls) {
+                    size_t cnt = astnode_array_count(n->data.program.decls);
+                    for (size_t i = cnt; i-- > 0; ) {
+                        AstNode *child = astnode_array_get(n->data.program.decls, i);
+                        walk_push_node(&w, child, ind + 1);
+                    }
                 }
+                break;
             }
-            break;
-            
-        }
 
-        case AST_IF_STATEMENT: {
-            print_indent(indent);
-            printf("IfStatement:\n");
-            if (node->data.if_statement.condition) {
-                print_indent(indent + 1); printf("Condition:\n");
-                print_ast(node->data.if_statement.condition, indent + 2);
-            }
-            if (node->data.if_statement.then_branch) {
-                print_indent(indent + 1); printf("Then:\n");
-                print_ast(node->data.if_statement.then_branch, indent + 2);
-            }
-            if (node->data.if_statement.else_branch) {
-                print_indent(indent + 1); printf("Else:\n");
-                print_ast(node->data.if_statement.else_branch, indent + 2);
+            case AST_VARIABLE_DECLARATION: {
+                print_indent(ind);
+                printf("Declaration:\n");
+                print_indent(ind + 1);
+                printf("Variable: %s\n", n->data.variable_declaration.name ? n->data.variable_declaration.name : "(anon)");
+                if (n->data.variable_declaration.initializer) {
+                    walk_push_node(&w, n->data.variable_declaration.initializer, ind + 3);
+                    walk_push_text(&w, "Initializer:", ind + 2);
+                }
+                if (n->data.variable_declaration.type) {
+                    walk_push_node(&w, n->data.variable_declaration.type, ind + 2);
+                }
+                break;
             }
-            break;
-        }
 
-        case AST_WHILE_STATEMENT: {
-            print_indent(indent);
-            printf("WhileLoop:\n");
-            if (node->data.while_statement.condition) {
-                print_indent(indent + 1); printf("Condition:\n");
-                print_ast(node->data.while_statement.condition, indent + 2);
-            }
-            if (node->data.while_statement.body) {
-                print_indent(indent + 1); printf("Body:\n");
-                print_ast(node->data.while_statement.body, indent + 2);
-            }
-            break;
-        }
+            case AST_FUNCTION_DECLARATION: {
+                print_indent(ind);
+                printf("Function: %s\n", n->data.function_declaration.name ? n->data.function_declaration.name : "(anon)");
+                if (n->data.function_declaration.body) {
+                    walk_push_node(&w, n->data.function_declaration.body, ind + 2);
+                    walk_push_text(&w, "Body:", ind + 1);
+                }
+
+                AstNodeArray *params = n->data.function_declaration.params;
+                if (params && astnode_array_count(params) > 0) {
+                    size_t cnt = astnode_array_count(params);
+                    for (size_t i = cnt; i-- > 0; ) {
+                        AstNode *p = astnode_array_get(params, i);
+                        if (p) walk_push_param(&w, p, ind + 2);
+                    }
+                    walk_push_text(&w, "Parameters:", ind + 1);
+                } else {
+                    walk_push_text(&w, "Parameters: (none)", ind + 1);
+                }
 
-        case AST_FOR_STATEMENT: {
-            print_indent(indent);
-            printf("ForLoop:\n");
-            if (node->data.for_statement.init) {
-                print_indent(indent + 1); printf("Init:\n");
-                print_ast(node->data.for_statement.init, indent + 2);
+                if (n->data.function_declaration.return_type) {
+                    walk_push_node(&w, n->data.function_declaration.return_type, ind + 2);
+                    walk_push_text(&w, "ReturnType:", ind + 1);
+                }
+                break;
             }
-            if (node->data.for_statement.condition) {
-                print_indent(indent + 1); printf("Condition:\n");
-                print_ast(node->data.for_statement.condition, indent + 2);
+
+            case AST_PARAM: {
+                print_indent(ind);
+                printf("Param: %s\n", n->data.param.name ? n->data.param.name : "(anon)");
+                if (n->data.param.type) {
+                    walk_push_node(&w, n->data.param.type, ind + 1);
+                }
+                break;
             }
-            if (node->data.for_statement.post) {
-                print_indent(indent + 1); printf("Post:\n");
-                print_ast(node->data.for_statement.post, indent + 2);
+
+            case AST_BLOCK: {
+                print_indent(ind);
+                printf("Block:\n");
+                if (n->data.block.statements) {
+                    size_t cnt = astnode_array_count(n->data.block.statements);
+                    for (size_t i = cnt; i-- > 0; ) {
+                        AstNode *stmt = astnode_array_get(n->data.block.statements, i);
+                        walk_push_node(&w, stmt, ind + 1);
+                    }
+                }
+                break;
             }
-            if (node->data.for_statement.body) {
-                print_indent(indent + 1); printf("Body:\n");
-                print_ast(node->data.for_statement.body, indent + 2);
+
+            case AST_IF_STATEMENT: {
+                print_indent(ind);
+                printf("IfStatement:\n");
+                if (n->data.if_statement.else_branch) {
+                    walk_push_node(&w, n->data.if_statement.else_branch, ind + 2);
+                    walk_push_text(&w, "Else:", ind + 1);
+                }
+                if (n->data.if_statement.then_branch) {
+                    walk_push_node(&w, n->data.if_statement.then_branch, ind + 2);
+                    walk_push_text(&w, "Then:", ind + 1);
+                }
+                if (n->data.if_statement.condition) {
+                    walk_push_node(&w, n->data.if_statement.condition, ind + 2);
+                    walk_push_text(&w, "Condition:", ind + 1);
+                }
+                break;
             }
-            break;
-        }
 
-        case AST_RETURN_STATEMENT: {
-            print_indent(indent);
-            printf("ReturnStatement:\n");
-            if (node->data.return_statement.expression) {
-                print_ast(node->data.return_statement.expression, indent + 1);
+            case AST_WHILE_STATEMENT: {
+                print_indent(ind);
+                printf("WhileLoop:\n");
+                if (n->data.while_statement.body) {
+                    walk_push_node(&w, n->data.while_statement.body, ind + 2);
+                    walk_push_text(&w, "Body:", ind + 1);
+                }
+                if (n->data.while_statement.condition) {
+                    walk_push_node(&w, n->data.while_statement.condition, ind + 2);
+                    walk_push_text(&w, "Condition:", ind + 1);
+                }
+                break;
             }
-            break;
-        }
 
-        case AST_BREAK_STATEMENT: {
-            print_indent(indent);
-            printf("BreakStatement\n");
-            break;
-        }
+            case AST_FOR_STATEMENT: {
+                print_indent(ind);
+                printf("ForLoop:\n");
+                if (n->data.for_statement.body) {
+                    walk_push_node(&w, n->data.for_statement.body, ind + 2);
+                    walk_push_text(&w, "Body:", ind + 1);
+                }
+                if (n->data.for_statement.post) {
+                    walk_push_node(&w, n->data.for_statement.post, ind + 2);
+                    walk_push_text(&w, "Post:", ind + 1);
+                }
+                if (n->data.for_statement.condition) {
+                    walk_push_node(&w, n->data.for_statement.condition, ind + 2);
+                    walk_push_text(&w, "Condition:", ind + 1);
+                }
+                if (n->data.for_statement.init) {
+                    walk_push_node(&w, n->data.for_statement.init, ind + 2);
+                    walk_push_text(&w, "Init:", ind + 1);
+                }
+                break;
+            }
 
-        case AST_CONTINUE_STATEMENT: {
-            print_indent(indent);
-            printf("ContinueStatement\n");
-            break;
-        }
+            case AST_RETURN_STATEMENT: {
+                print_indent(ind);
+                printf("ReturnStatement:\n");
+                if (n->data.return_statement.expression) {
+                    walk_push_node(&w, n->data.return_statement.expression, ind + 1);
+                }
+                break;
+            }
 
-        case AST_EXPR_STATEMENT: {
-            print_indent(indent);
-            printf("ExprStatement:\n");
-            if (node->data.expr_statement.expression) {
-                print_ast(node->data.expr_statement.expression, indent + 1);
+            case AST_BREAK_STATEMENT: {
+                print_indent(ind);
+                printf("BreakStatement\n");
+                break;
             }
-            break;
-        }
 
-        case AST_LITERAL: {
-            print_indent(indent);
-            printf("Literal: ");
-            switch (node->data.literal.type) {
-                case INT_LITERAL:
-                    printf("Integer: %s\n", node->data.literal.value ? node->data.literal.value : "(null)");
-                    break;
-                case FLOAT_LITERAL:
-                    printf("Float: %s\n", node->data.literal.value ? node->data.literal.value : "(null)");
-                    break;
-                case BOOL_LITERAL:
-                    printf("Boolean: %s\n", node->data.literal.value ? node->data.literal.value : "(null)");
-                    break;
-                case LIT_UNKNOWN:
-                    printf("Unknown literal type (should not happen)\n");
-                    break;
+            case AST_CONTINUE_STATEMENT: {
+                print_indent(ind);
+                printf("ContinueStatement\n");
+                break;
             }
-            break;
-        }
 
-        case AST_IDENTIFIER: {
-            print_indent(indent);
-            printf("Variable: %s\n", node->data.identifier.identifier ? node->data.identifier.identifier : "(anon)");
-            break;
-        }
+            case AST_EXPR_STATEMENT: {
+                print_indent(ind);
+                printf("ExprStatement:\n");
+                if (n->data.expr_statement.expression) {
+                    walk_push_node(&w, n->data.expr_statement.expression, ind + 1);
+                }
+                break;
+            }
+
+            case AST_LITERAL: {
+                print_indent(ind);
+                printf("Literal: ");
+                switch (n->data.literal.type) {
+                    case INT_LITERAL:
+                        printf("Integer: %s\n", n->data.literal.value ? n->data.literal.value : "(null)");
+                        break;
+                    case FLOAT_LITERAL:
+                        printf("Float: %s\n", n->data.literal.value ? n->data.literal.value : "(null)");
+                        break;
+                    case BOOL_LITERAL:
+                        printf("Boolean: %s\n", n->data.literal.value ? n->data.literal.value : "(null)");
+                        break;
+                    case LIT_UNKNOWN:
+                        printf("Unknown literal type (should not happen)\n");
+                        break;
+                }
+                break;
+            }
 
-        case AST_BINARY_EXPR: {
-            print_indent(indent);
-            printf("BinaryOp: %s\n", opkind_to_string(node->data.binary_expr.op));
-            if (node->data.binary_expr.left) print_ast(node->data.binary_expr.left, indent + 1);
-            if (node->data.binary_expr.right) print_ast(node->data.binary_expr.right, indent + 1);
-            break;
-        }
+            case AST_IDENTIFIER: {
+                print_indent(ind);
+                printf("Variable: %s\n", n->data.identifier.identifier ? n->data.identifier.identifier : "(anon)");
+                break;
+            }
 
-        case AST_UNARY_EXPR: {
-            print_indent(indent);
-            printf("UnaryOp: %s\n", opkind_to_string(node->data.unary_expr.op));
-            if (node->data.unary_expr.expr) print_ast(node->data.unary_expr.expr, indent + 1);
-            break;
-        }
+            case AST_BINARY_EXPR: {
+                print_indent(ind);
+                printf("BinaryOp: %s\n", opkind_to_string(n->data.binary_expr.op));
+                if (n->data.binary_expr.right) walk_push_node(&w, n->data.binary_expr.right, ind + 1);
+                if (n->data.binary_expr.left) walk_push_node(&w, n->data.binary_expr.left, ind + 1);
+                break;
+            }
 
-        case AST_POSTFIX_EXPR: {
-            print_indent(indent);
-            printf("PostfixOp: %s\n", opkind_to_string(node->data.postfix_expr.op));
-            if (node->data.postfix_expr.expr) print_ast(node->data.postfix_expr.expr, indent + 1);
-            break;
-        }
+            case AST_UNARY_EXPR: {
+                print_indent(ind);
+                printf("UnaryOp: %s\n", opkind_to_string(n->data.unary_expr.op));
+                if (n->data.unary_expr.expr) walk_push_node(&w, n->data.unary_expr.expr, ind + 1);
+                break;
+            }
 
-        case AST_ASSIGNMENT_EXPR: {
-            print_indent(indent);
-            printf("Assignment: %s\n", opkind_to_string(node->data.assignment_expr.op));
-            if (node->data.assignment_expr.lvalue) print_ast(node->data.assignment_expr.lvalue, indent + 1);
-            if (node->data.assignment_expr.rvalue) print_ast(node->data.assignment_expr.rvalue, indent + 1);
-            break;
-        }
+            case AST_POSTFIX_EXPR: {
+                print_indent(ind);
+                printf("PostfixOp: %s\n", opkind_to_string(n->data.postfix_expr.op));
+                if (n->data.postfix_expr.expr) walk_push_node(&w, n->data.postfix_expr.expr, ind + 1);
+                break;
+            }
 
-        case AST_CALL_EXPR: {
-            print_indent(indent);
-            printf("Call:\n");
-            if (node->data.call_expr.callee) {
-                print_indent(indent + 1); printf("Callee:\n");
-                print_ast(node->data.call_expr.callee, indent + 2);
+            case AST_ASSIGNMENT_EXPR: {
+                print_indent(ind);
+                printf("Assignment: %s\n", opkind_to_string(n->data.assignment_expr.op));
+                if (n->data.assignment_expr.rvalue) walk_push_node(&w, n->data.assignment_expr.rvalue, ind + 1);
+                if (n->data.assignment_expr.lvalue) walk_push_node(&w, n->data.assignment_expr.lvalue, ind + 1);
+                break;
             }
-            /* use dynarray helpers for args */
-            if (node->data.call_expr.args) {
-                size_t nargs = astnode_array_count(node->data.call_expr.args);
-                if (nargs) {
-                    print_call_args(node->data.call_expr.args, indent + 1);
+
+            case AST_CALL_EXPR: {
+                print_indent(ind);
+                printf("Call:\n");
+                AstNodeArray *args = n->data.call_expr.args;
+                if (args && astnode_array_count(args) > 0) {
+                    size_t cnt = astnode_array_count(args);
+                    for (size_t i = cnt; i-- > 0; ) {
+                        AstNode *arg = astnode_array_get(args, i);
+                        if (arg) walk_push_node(&w, arg, ind + 2);
+                    }
+                    walk_push_text(&w, "Args:", ind + 1);
                 } else {
-                    print_indent(indent + 1);
-                    printf("Args: (none)\n");
+                    walk_push_text(&w, "Args: (none)", ind + 1);
                 }
-            } else {
-                print_indent(indent + 1);
-                printf("Args: (none)\n");
+                if (n->data.call_expr.callee) {
+                    walk_push_node(&w, n->data.call_expr.callee, ind + 2);
+                    walk_push_text(&w, "Callee:", ind + 1);
+                }
+                break;
             }
-            break;
-        }
 
-        case AST_SUBSCRIPT_EXPR: {
-            print_indent(indent);
-            printf("Subscript:\n");
-            if (node->data.subscript_expr.target) {
-                print_indent(indent + 1);
-                printf("Target:\n");
-                print_ast(node->data.subscript_expr.target, indent + 2);
-            }
-            if (node->data.subscript_expr.index) {
-                print_indent(indent + 1);
-                printf("Index:\n");
-                print_ast(node->data.subscript_expr.index, indent + 2);
+            case AST_SUBSCRIPT_EXPR: {
+                print_indent(ind);
+                printf("Subscript:\n");
+                if (n->data.subscript_expr.index) {
+                    walk_push_node(&w, n->data.subscript_expr.index, ind + 2);
+                    walk_push_text(&w, "Index:", ind + 1);
+                }
+                if (n->data.subscript_expr.target) {
+                    walk_push_node(&w, n->data.subscript_expr.target, ind + 2);
+                    walk_push_text(&w, "Target:", ind + 1);
+                }
+                break;
             }
-            break;
-        }
 
-        case AST_TYPE: {
-            print_indent(indent);
-            
-            if (node->data.ast_type.is_function) {
-                printf("Function-type:\n");
-                
-                // Show const qualifier
-                if (node->data.ast_type.base_is_const) {
-                    print_indent(indent + 1);
-                    printf("Const: true\n");
+            case AST_TYPE: {
+                print_indent(ind);
+
+                /* common tail, pushed first so it prints last */
+                if (n->data.ast_type.post_stars > 0) {
+                    walk_push_fmt(&w, "PostStars: %zu\n", n->data.ast_type.post_stars, ind + 1);
                 }
-                
-                // Show parameter types
-                if (node->data.ast_type.param_types) {
-                    print_indent(indent + 1);
-                    printf("Parameters:\n");
-                    size_t param_count = astnode_array_count(node->data.ast_type.param_types);
-                    for (size_t i = 0; i < param_count; ++i) {
-                        AstNode *param_type = astnode_array_get(node->data.ast_type.param_types, i);
-                        if (param_type) {
-                            print_ast(param_type, indent + 2);
+
+                if (n->data.ast_type.sizes && astnode_array_count(n->data.ast_type.sizes) > 0) {
+                    size_t cnt = astnode_array_count(n->data.ast_type.sizes);
+                    for (size_t i = cnt; i-- > 0; ) {
+                        AstNode *dim = astnode_array_get(n->data.ast_type.sizes, i);
+                        if (dim) {
+                            walk_push_node(&w, dim, ind + 3);
+                        } else {
+                            walk_push_text(&w, "(empty)", ind + 3);
                         }
+                        walk_push_fmt(&w, "Dimension[%zu]:\n", i, ind + 2);
                     }
-                } else {
-                    print_indent(indent + 1);
-                    printf("Parameters: (none)\n");
-                }
-                
-                // Show return type
-                if (node->data.ast_type.return_type) {
-                    print_indent(indent + 1);
-                    printf("ReturnType:\n");
-                    print_ast(node->data.ast_type.return_type, indent + 2);
+                    walk_push_text(&w, "ArrayDimensions:", ind + 1);
                 }
-                
-            } else if (!node->data.ast_type.base_type && node->data.ast_type.return_type) {
-                // Parenthesized/grouped type
-                printf("Grouped-type:\n");
-                
-                // Show const qualifier
-                if (node->data.ast_type.base_is_const) {
-                    print_indent(indent + 1);
-                    printf("Const: true\n");
-                }
-                
-                // Show inner type
-                print_indent(indent + 1);
-                printf("InnerType:\n");
-                print_ast(node->data.ast_type.return_type, indent + 2);
-                
-            } else {
-                // Regular base type
-                printf("Type:\n");
-                
-                // Show const qualifier
-                if (node->data.ast_type.base_is_const) {
-                    print_indent(indent + 1);
-                    printf("Const: true\n");
+
+                if (n->data.ast_type.pre_stars > 0) {
+                    walk_push_fmt(&w, "PreStars: %zu\n", n->data.ast_type.pre_stars, ind + 1);
                 }
-                
-                // Show base type
-                print_indent(indent + 1);
-                printf("BaseType: %s\n", node->data.ast_type.base_type ? node->data.ast_type.base_type : "?");
-            }
-            
-            // Show pre-stars
-            if (node->data.ast_type.pre_stars > 0) {
-                print_indent(indent + 1);
-                printf("PreStars: %zu\n", node->data.ast_type.pre_stars);
-            }
-            
-            // Show array dimensions with their expressions
-            if (node->data.ast_type.sizes && astnode_array_count(node->data.ast_type.sizes) > 0) {
-                print_indent(indent + 1);
-                printf("ArrayDimensions:\n");
-                size_t n = astnode_array_count(node->data.ast_type.sizes);
-                for (size_t i = 0; i < n; ++i) {
-                    AstNode *dim = astnode_array_get(node->data.ast_type.sizes, i);
-                    print_indent(indent + 2);
-                    printf("Dimension[%zu]:\n", i);
-                    if (dim) {
-                        print_ast(dim, indent + 3);
+
+                if (n->data.ast_type.is_function) {
+                    printf("Function-type:\n");
+
+                    if (n->data.ast_type.base_is_const) {
+                        print_indent(ind + 1);
+                        printf("Const: true\n");
+                    }
+
+                    if (n->data.ast_type.return_type) {
+                        walk_push_node(&w, n->data.ast_type.return_type, ind + 2);
+                        walk_push_text(&w, "ReturnType:", ind + 1);
+                    }
+
+                    if (n->data.ast_type.param_types) {
+                        size_t cnt = astnode_array_count(n->data.ast_type.param_types);
+                        for (size_t i = cnt; i-- > 0; ) {
+                            AstNode *param_type = astnode_array_get(n->data.ast_type.param_types, i);
+                            if (param_type) walk_push_node(&w, param_type, ind + 2);
+                        }
+                        walk_push_text(&w, "Parameters:", ind + 1);
                     } else {
-                        print_indent(indent + 3);
-                        printf("(empty)\n");
+                        walk_push_text(&w, "Parameters: (none)", ind + 1);
                     }
+
+                } else if (!n->data.ast_type.base_type && n->data.ast_type.return_type) {
+                    /* Parenthesized/grouped type */
+                    printf("Grouped-type:\n");
+
+                    if (n->data.ast_type.base_is_const) {
+                        print_indent(ind + 1);
+                        printf("Const: true\n");
+                    }
+
+                    walk_push_node(&w, n->data.ast_type.return_type, ind + 2);
+                    walk_push_text(&w, "InnerType:", ind + 1);
+
+                } else {
+                    /* Regular base type */
+                    printf("Type:\n");
+
+                    if (n->data.ast_type.base_is_const) {
+                        print_indent(ind + 1);
+                        printf("Const: true\n");
+                    }
+
+                    print_indent(ind + 1);
+                    printf("BaseType: %s\n", n->data.ast_type.base_type ? n->data.ast_type.base_type : "?");
                 }
+                break;
             }
-            
-            // Show post-stars
-            if (node->data.ast_type.post_stars > 0) {
-                print_indent(indent + 1);
-                printf("PostStars: %zu\n", node->data.ast_type.post_stars);
-            }
-            
-            break;
-        }
-        case AST_INITIALIZER_LIST: {
-            print_indent(indent);
-            printf("InitializerList:\n");
-            if (node->data.initializer_list.elements) {
-                size_t n = astnode_array_count(node->data.initializer_list.elements);
-                for (size_t i = 0; i < n; ++i) {
-                    AstNode *child = astnode_array_get(node->data.initializer_list.elements, i);
-                    print_ast(child, indent + 1);
+
+            case AST_INITIALIZER_LIST: {
+                print_indent(ind);
+                printf("InitializerList:\n");
+                if (n->data.initializer_list.elements) {
+                    size_t cnt = astnode_array_count(n->data.initializer_list.elements);
+                    for (size_t i = cnt; i-- > 0; ) {
+                        AstNode *child = astnode_array_get(n->data.initializer_list.elements, i);
+                        walk_push_node(&w, child, ind + 1);
+                    }
                 }
+                break;
             }
-            break;
-        }
 
-        default: {
-            print_indent(indent);
-            printf("Unhandled node type: %d\n", (int)node->node_type);
-            break;
+            default: {
+                print_indent(ind);
+                printf("Unhandled node type: %d\n", (int)n->node_type);
+                break;
+            }
         }
     }
-}
 
+    walk_dispose(&w);
+}
@@ -0,0 +1,100 @@
+#include "ast_bin.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* -----------------------
+ * writer
+ * --------------------- */
+
+int ast_bin_write(const AstNode *root, const char *path) {
+    if (!root || !path) return -1;
+
+    /* flatten into the in-memory pool; the file is a plain dump of
+       its three sections behind a header */
+    AstPool pool;
+    if (ast_pool_build(&pool, root) != 0) return -1;
+
+    AstBinHeader hdr;
+    memcpy(hdr.magic, AST_BIN_MAGIC, 4);
+    hdr.version = AST_BIN_VERSION;
+    hdr.node_count = pool.node_count;
+    hdr.child_count = pool.child_count;
+    hdr.string_bytes = pool.string_bytes;
+    hdr.root = pool.root;
+
+    int rc = -1;
+    FILE *f = fopen(path, "wb");
+    if (f) {
+        if (fwrite(&hdr, sizeof hdr, 1, f) == 1 &&
+            (pool.node_count == 0 ||
+             fwrite(pool.nodes, sizeof(AstPoolNode), pool.node_count, f) == pool.node_count) &&
+            (pool.child_count == 0 ||
+             fwrite(pool.children, sizeof(uint32_t), pool.child_count, f) == pool.child_count) &&
+            (pool.string_bytes == 0 ||
+             fwrite(pool.strings, 1, pool.string_bytes, f) == pool.string_bytes)) {
+            rc = 0;
+        }
+        if (fclose(f) != 0) rc = -1;
+    } else {
+        perror("fopen");
+    }
+
+    ast_pool_free(&pool);
+    return rc;
+}
+
+/* -----------------------
+ * reader
+ * --------------------- */
+
+int ast_bin_open(AstBinFile *f, const char *path) {
+    memset(f, 0, sizeof *f);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AstBinHeader)) {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    const AstBinHeader *hdr = map;
+    size_t need = sizeof(AstBinHeader)
+                + (size_t)hdr->node_count * sizeof(AstPoolNode)
+                + (size_t)hdr->child_count * sizeof(uint32_t)
+                + hdr->string_bytes;
+    if (memcmp(hdr->magic, AST_BIN_MAGIC, 4) != 0 ||
+        hdr->version != AST_BIN_VERSION ||
+        need > (size_t)st.st_size ||
+        (hdr->node_count > 0 && hdr->root >= hdr->node_count)) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    f->header = hdr;
+    f->nodes = (const AstPoolNode *)((const char *)map + sizeof(AstBinHeader));
+    f->children = (const uint32_t *)(f->nodes + hdr->node_count);
+    f->strings = (const char *)(f->children + hdr->child_count);
+    f->map = map;
+    f->map_len = (size_t)st.st_size;
+    return 0;
+}
+
+void ast_bin_close(AstBinFile *f) {
+    if (!f || !f->map) return;
+    munmap(f->map, f->map_len);
+    memset(f, 0, sizeof *f);
+}
@@ -1,8 +1,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
 
 #include "ast_parse_statements.h"
+#include "arena.h"
+#include "intern.h"
 
 /*
  * This file contains implementations of the lang.bnf specification
@@ -25,7 +28,7 @@ AstNode *parse_program(Parser *p, ParseError *err) {
     }
     
     /* Allocate the decls array since it's now a pointer */
-    program->data.program.decls = malloc(sizeof(AstNodeArray));
+    program->data.program.decls = arena_alloc_current(sizeof(AstNodeArray));
     if (!program->data.program.decls) {
         ast_node_free(program);
         if (err) create_parse_error(err, "out of memory creating program decls", p);
@@ -110,7 +113,7 @@ AstNode *parse_function_declaration(Parser *p, ParseError *err) {
     /* name */
     Token *name_tok = consume(p, TOK_IDENTIFIER);
     if (!name_tok) { fail_with(p, func_decl, err, "expected function name"); return NULL; }
-    func_decl->data.function_declaration.name = name_tok->lexeme ? strdup(name_tok->lexeme) : NULL;
+    func_decl->data.function_declaration.name = (char *)token_lexeme_intern(name_tok);
 
     /* parameters */
     if (!consume(p, TOK_LPAREN)) { fail_with(p, func_decl, err, "expected '(' after function name"); return NULL; }
@@ -219,7 +222,7 @@ AstNode *parse_variable_declaration(Parser *p, ParseError *err)
     /* name */
     Token *name_tok = consume(p, TOK_IDENTIFIER);
     if (!name_tok) { fail_with(p, var_decl, err, "expected identifier in variable declaration"); return NULL; }
-    var_decl->data.variable_declaration.name = name_tok->lexeme ? strdup(name_tok->lexeme) : NULL;
+    var_decl->data.variable_declaration.name = (char *)token_lexeme_intern(name_tok);
 
     /* colon */
     if (!consume(p, TOK_COLON)) { fail_with(p, var_decl, err, "expected ':' after variable name"); return NULL; }
@@ -316,8 +319,8 @@ AstNode *parse_type(Parser *p, ParseError *err) {
             return NULL;
         }
 
-        char *base_type_str = token->lexeme ? strdup(token->lexeme) : NULL;
-        if (token->lexeme && !base_type_str) {
+        char *base_type_str = (char *)token_lexeme_intern(token);
+        if (token->start && !base_type_str) {
             fail_with(p, type_node, err, "out of memory copying base type string");
             return NULL;
         }
@@ -412,7 +415,7 @@ int parse_function_type_inline(Parser *p, AstNode *type_node, ParseError *err) {
 
     // Mark this as a function type
     type_node->data.ast_type.is_function = 1;
-    type_node->data.ast_type.base_type = strdup("function");
+    type_node->data.ast_type.base_type = (char *)intern_str("function");
     if (!type_node->data.ast_type.base_type) {
         if (err) create_parse_error(err, "out of memory copying function base type", p);
         return 0;
@@ -569,7 +572,7 @@ AstNode *parse_assignment(Parser *p, AstNode *lhs, ParseError *err) {
  * the parsed LHS to parse_assignment (which takes ownership).
  */
 AstNode *parse_expression(Parser *p, ParseError *err) {
-    AstNode *lhs = parse_logical_or(p, err);
+    AstNode *lhs = parse_binary_expr(p, err, 1);
     if (!lhs) return NULL;
 
     Token *token = current_token(p);
@@ -717,144 +720,258 @@ AstNode *parse_initializer_list(Parser *p, AstNode *type_node, ParseError *err)
 
 
 
- /* operand_parser: parse one operand/sublevel and return AST node (or NULL on error). */
-typedef AstNode *(*operand_parser_fn)(Parser *p, ParseError *err);
+/* ---------------------------
+ * Parse-time constant folding
+ *
+ * Literals get their ConstValue decoded as they are built, and the
+ * binary/unary parsers collapse all-constant subtrees back into a
+ * single AST_LITERAL before an operator node is ever allocated.
+ * Generated inputs carry huge constant expressions (array sizes,
+ * table initializers); folding them here shrinks the AST before any
+ * downstream pass sees it. Anything that could change observable
+ * behaviour — division by zero, signed overflow, mixed int/float
+ * operands — is left unfolded for the later phases to judge.
+ * --------------------------- */
+
+/* Decode a literal's lexeme into its ConstValue and mark it constant.
+ * Called once, when the literal node is built in parse_primary(). */
+static void literal_attach_const(AstNode *lit) {
+    const char *s = lit->data.literal.value;
+    if (!s) return;
+
+    ConstValue v;
+    switch (lit->data.literal.type) {
+        case INT_LITERAL:
+            v.kind = INT_LITERAL;
+            v.int_val = strtoll(s, NULL, 10);
+            break;
+        case FLOAT_LITERAL:
+            v.kind = FLOAT_LITERAL;
+            v.float_val = strtod(s, NULL);
+            break;
+        case BOOL_LITERAL:
+            v.kind = BOOL_LITERAL;
+            v.bool_val = (strcmp(s, "true") == 0);
+            break;
+        default:
+            return;
+    }
 
-/* map_token_to_op: return OP_* for this token, or -1 if token not handled. */
-typedef OpKind (*map_token_to_op_fn)(Token *tok);
+    ConstValue *cv = arena_alloc_current(sizeof *cv);
+    *cv = v;
+    lit->const_value = cv;
+    lit->is_const_expr = 1;
+}
 
-/* Generic left-associative binary parser:
- * - parse_operand parses the left/right subexpressions
- * - map_op returns the operator enum for the current token or OP_NULL if not an operator
- */
-static AstNode *parse_left_assoc_binary(Parser *p, ParseError *err,
-                        operand_parser_fn parse_operand,
-                        map_token_to_op_fn map_op,
-                        const char *oom_msg)
-{
-    AstNode *lhs = parse_operand(p, err);
-    if (!lhs) return NULL;
+/* Rewrite an existing literal node to hold v (value, lexeme, kind).
+ * Folding therefore reuses the left operand's node and allocates
+ * nothing beyond the new lexeme string. */
+static void literal_set_value(AstNode *lit, ConstValue v) {
+    char buf[64];
+    switch (v.kind) {
+        case INT_LITERAL:
+            snprintf(buf, sizeof buf, "%lld", v.int_val);
+            break;
+        case FLOAT_LITERAL:
+            snprintf(buf, sizeof buf, "%g", v.float_val);
+            break;
+        case BOOL_LITERAL:
+            snprintf(buf, sizeof buf, "%s", v.bool_val ? "true" : "false");
+            break;
+        default:
+            return;
+    }
 
-    Token *token = current_token(p);
-    int op;
-    while (token && (op = map_op(token)) != OP_NULL) {
-        /* consume the exact token type we saw */
-        consume(p, token->type);
+    if (!arena_active()) free(lit->data.literal.value);
+    lit->data.literal.value = arena_strdup_current(buf);
+    lit->data.literal.type = v.kind;
+    *lit->const_value = v;
+    lit->is_const_expr = 1;
+}
 
-        AstNode *rhs = parse_operand(p, err);
-        if (!rhs) {
-            ast_node_free(lhs);
-            return NULL; /* err set by parse_operand */
+/* Evaluate op over two constants. Returns 1 and fills *out when the
+ * fold is safe, 0 when it must be left to later phases. */
+static int const_eval_binary(OpKind op, const ConstValue *a,
+                             const ConstValue *b, ConstValue *out) {
+    if (a->kind != b->kind) return 0; /* no implicit promotions here */
+
+    if (a->kind == INT_LITERAL) {
+        long long x = a->int_val, y = b->int_val, r;
+        switch (op) {
+            case OP_ADD: if (__builtin_add_overflow(x, y, &r)) return 0; break;
+            case OP_SUB: if (__builtin_sub_overflow(x, y, &r)) return 0; break;
+            case OP_MUL: if (__builtin_mul_overflow(x, y, &r)) return 0; break;
+            case OP_DIV:
+                if (y == 0 || (x == LLONG_MIN && y == -1)) return 0;
+                r = x / y;
+                break;
+            case OP_MOD:
+                if (y == 0 || (x == LLONG_MIN && y == -1)) return 0;
+                r = x % y;
+                break;
+            case OP_EQ:  out->kind = BOOL_LITERAL; out->bool_val = x == y; return 1;
+            case OP_NEQ: out->kind = BOOL_LITERAL; out->bool_val = x != y; return 1;
+            case OP_LT:  out->kind = BOOL_LITERAL; out->bool_val = x <  y; return 1;
+            case OP_GT:  out->kind = BOOL_LITERAL; out->bool_val = x >  y; return 1;
+            case OP_LE:  out->kind = BOOL_LITERAL; out->bool_val = x <= y; return 1;
+            case OP_GE:  out->kind = BOOL_LITERAL; out->bool_val = x >= y; return 1;
+            default: return 0;
         }
+        out->kind = INT_LITERAL;
+        out->int_val = r;
+        return 1;
+    }
 
-        AstNode *bin = ast_create_node(AST_BINARY_EXPR);
-        if (!bin) {
-            if (err) create_parse_error(err, oom_msg ? oom_msg : "out of memory creating binary node", p);
-            ast_node_free(lhs);
-            ast_node_free(rhs);
-            return NULL;
+    if (a->kind == FLOAT_LITERAL) {
+        double x = a->float_val, y = b->float_val;
+        switch (op) {
+            case OP_ADD: out->float_val = x + y; break;
+            case OP_SUB: out->float_val = x - y; break;
+            case OP_MUL: out->float_val = x * y; break;
+            case OP_DIV:
+                if (y == 0.0) return 0;
+                out->float_val = x / y;
+                break;
+            case OP_EQ:  out->kind = BOOL_LITERAL; out->bool_val = x == y; return 1;
+            case OP_NEQ: out->kind = BOOL_LITERAL; out->bool_val = x != y; return 1;
+            case OP_LT:  out->kind = BOOL_LITERAL; out->bool_val = x <  y; return 1;
+            case OP_GT:  out->kind = BOOL_LITERAL; out->bool_val = x >  y; return 1;
+            case OP_LE:  out->kind = BOOL_LITERAL; out->bool_val = x <= y; return 1;
+            case OP_GE:  out->kind = BOOL_LITERAL; out->bool_val = x >= y; return 1;
+            default: return 0; /* no % on floats */
         }
-
-        bin->data.binary_expr.left  = lhs;
-        bin->data.binary_expr.right = rhs;
-        bin->data.binary_expr.op    = op;
-
-        lhs = bin;                  /* new accumulated LHS */
-        token = current_token(p);   /* next token */
+        out->kind = FLOAT_LITERAL;
+        return 1;
     }
 
-    return lhs;
+    /* booleans */
+    switch (op) {
+        case OP_AND: out->bool_val = a->bool_val && b->bool_val; break;
+        case OP_OR:  out->bool_val = a->bool_val || b->bool_val; break;
+        case OP_EQ:  out->bool_val = a->bool_val == b->bool_val; break;
+        case OP_NEQ: out->bool_val = a->bool_val != b->bool_val; break;
+        default: return 0;
+    }
+    out->kind = BOOL_LITERAL;
+    return 1;
 }
 
-OpKind map_logical_or_op(Token *tok) {
-    if (!tok) return OP_NULL;
-    switch (tok->type) {
-        case TOK_OR_OR: return OP_OR;
-        default:     return OP_NULL; // not a logical-or operator
+/* Unary counterpart: negation and logical not. */
+static int const_eval_unary(OpKind op, const ConstValue *a, ConstValue *out) {
+    switch (op) {
+        case OP_SUB:
+            if (a->kind == INT_LITERAL) {
+                if (a->int_val == LLONG_MIN) return 0;
+                out->kind = INT_LITERAL;
+                out->int_val = -a->int_val;
+                return 1;
+            }
+            if (a->kind == FLOAT_LITERAL) {
+                out->kind = FLOAT_LITERAL;
+                out->float_val = -a->float_val;
+                return 1;
+            }
+            return 0;
+        case OP_ADD:
+            if (a->kind == INT_LITERAL || a->kind == FLOAT_LITERAL) {
+                *out = *a;
+                return 1;
+            }
+            return 0;
+        case OP_NOT:
+            if (a->kind == BOOL_LITERAL) {
+                out->kind = BOOL_LITERAL;
+                out->bool_val = !a->bool_val;
+                return 1;
+            }
+            return 0;
+        default:
+            return 0;
     }
 }
 
-// <LogicalOr> ::= <LogicalAnd> { OR <LogicalAnd> }
-AstNode *parse_logical_or(Parser *p, ParseError *err) {
-    return parse_left_assoc_binary(p, err, parse_logical_and,
-                                      map_logical_or_op, "out of memory creating logical-or node");
-}
+/* ---------------------------
+ * Binary expressions: one precedence-climbing loop instead of a fixed
+ * cascade of per-level functions, driven by a token -> (op, precedence)
+ * table. Higher precedence binds tighter; every binary operator in the
+ * grammar is left-associative.
+ * --------------------------- */
 
-OpKind map_logical_and_op(Token *tok) {
-    if (!tok) return OP_NULL;
-    switch (tok->type) {
-        case TOK_AND_AND: return OP_AND;
-        default:     return OP_NULL; // not a logical-and operator
+typedef struct {
+    OpKind op;
+    int prec; /* 0 = not a binary operator */
+} BinOpInfo;
+
+static BinOpInfo binop_info(TokenType type) {
+    switch (type) {
+        case TOK_OR_OR:    return (BinOpInfo){ OP_OR,  1 };
+        case TOK_AND_AND:  return (BinOpInfo){ OP_AND, 2 };
+        case TOK_EQ_EQ:    return (BinOpInfo){ OP_EQ,  3 };
+        case TOK_BANG_EQ:  return (BinOpInfo){ OP_NEQ, 3 };
+        case TOK_LT:       return (BinOpInfo){ OP_LT,  4 };
+        case TOK_GT:       return (BinOpInfo){ OP_GT,  4 };
+        case TOK_LT_EQ:    return (BinOpInfo){ OP_LE,  4 };
+        case TOK_GT_EQ:    return (BinOpInfo){ OP_GE,  4 };
+        case TOK_PLUS:     return (BinOpInfo){ OP_ADD, 5 };
+        case TOK_MINUS:    return (BinOpInfo){ OP_SUB, 5 };
+        case TOK_STAR:     return (BinOpInfo){ OP_MUL, 6 };
+        case TOK_SLASH:    return (BinOpInfo){ OP_DIV, 6 };
+        case TOK_PERCENT:  return (BinOpInfo){ OP_MOD, 6 };
+        default:           return (BinOpInfo){ OP_NULL, 0 };
     }
 }
 
-// <LogicalAnd> ::= <Equality> { AND <Equality> }
-AstNode *parse_logical_and(Parser *p, ParseError *err) {
-    return parse_left_assoc_binary(p, err, parse_equality,
-                                      map_logical_and_op, "out of memory creating logical-and node");
-}
+/* Parse a binary expression whose operators all bind at least as
+ * tightly as min_prec. Equal-precedence operators stay on the left
+ * (the recursion uses info.prec + 1), preserving the associativity of
+ * the old cascade. */
+AstNode *parse_binary_expr(Parser *p, ParseError *err, int min_prec) {
+    AstNode *lhs = parse_unary(p, err);
+    if (!lhs) return NULL;
 
-OpKind map_equality_op(Token *tok) {
-    if (!tok) return OP_NULL;
-    switch (tok->type) {
-        case TOK_EQ_EQ: return OP_EQ;
-        case TOK_BANG_EQ:   return OP_NEQ;
-        default:        return OP_NULL; // not an equality operator
-    }
-}
+    for (;;) {
+        Token *token = current_token(p);
+        if (!token) break;
+        BinOpInfo info = binop_info(token->type);
+        if (info.prec == 0 || info.prec < min_prec) break;
 
-// <Equality> ::= <Relational> { ( EQ_EQ | BANG_EQ ) <Relational> }
-AstNode *parse_equality(Parser *p, ParseError *err) {
-    return parse_left_assoc_binary(p, err, parse_relational,
-                                      map_equality_op, "out of memory creating equality node");
-}   
+        consume(p, token->type);
 
-OpKind map_relational_op(Token *tok) {
-    if (!tok) return OP_NULL;
-    switch (tok->type) {
-        case TOK_LT: return OP_LT;
-        case TOK_GT: return OP_GT;
-        case TOK_LT_EQ: return OP_LE;
-        case TOK_GT_EQ: return OP_GE;
-        default:     return OP_NULL; // not a relational operator
-    }
-}
+        AstNode *rhs = parse_binary_expr(p, err, info.prec + 1);
+        if (!rhs) {
+            ast_node_free(lhs);
+            return NULL; /* err set below us */
+        }
 
-// <Relational> ::= <Additive> { ( LT | GT | LT_EQ | GT_EQ ) <Additive> }
-AstNode *parse_relational(Parser *p, ParseError *err) {
-    return parse_left_assoc_binary(p, err, parse_additive,
-                                      map_relational_op, "out of memory creating relational node");
-}
+        /* constant subtree: collapse into the left literal in place */
+        if (lhs->node_type == AST_LITERAL && rhs->node_type == AST_LITERAL &&
+            lhs->const_value && rhs->const_value) {
+            ConstValue v;
+            if (const_eval_binary(info.op, lhs->const_value,
+                                  rhs->const_value, &v)) {
+                literal_set_value(lhs, v);
+                ast_node_free(rhs);
+                continue;
+            }
+        }
 
-OpKind map_additive_op(Token *tok) {
-    if (!tok) return OP_NULL;
-    switch (tok->type) {
-        case TOK_PLUS: return OP_ADD;
-        case TOK_MINUS: return OP_SUB;
-        default:     return OP_NULL; // not an additive operator
-    }
-}
-// <Additive> ::= <Multiplicative> { ( PLUS | MINUS ) <Multiplicative> }
-AstNode *parse_additive(Parser *p, ParseError *err) {
-    return parse_left_assoc_binary(p, err, parse_multiplicative,
-                                      map_additive_op, "out of memory creating additive node");
-}
+        AstNode *bin = ast_create_node(AST_BINARY_EXPR);
+        if (!bin) {
+            if (err) create_parse_error(err, "out of memory creating binary node", p);
+            ast_node_free(lhs);
+            ast_node_free(rhs);
+            return NULL;
+        }
 
-OpKind map_multiplicative_op(Token *tok) {
-    if (!tok) return OP_NULL;
-    switch (tok->type) {
-        case TOK_STAR: return OP_MUL;
-        case TOK_SLASH: return OP_DIV;
-        case TOK_PERCENT: return OP_MOD;
-        default:     return OP_NULL; // not a multiplicative operator
+        bin->data.binary_expr.left  = lhs;
+        bin->data.binary_expr.right = rhs;
+        bin->data.binary_expr.op    = info.op;
+
+        lhs = bin; /* new accumulated LHS */
     }
-}
 
-// <Multiplicative> ::= <Unary> { ( STAR | SLASH | PERCENT ) <Unary> }
-AstNode *parse_multiplicative(Parser *p, ParseError *err) {
-    return parse_left_assoc_binary(p, err, parse_unary, 
-                                      map_multiplicative_op, "out of memory creating multiplicative node");
-}   
+    return lhs;
+}
 
 OpKind map_unary_op(Token *tok) { if (!tok) return OP_NULL; 
     switch (tok->type) { 
@@ -891,6 +1008,15 @@ AstNode *parse_unary(Parser *p, ParseError *err) {
             return NULL;
         }
 
+        /* constant operand: fold the operator into the literal */
+        if (operand->node_type == AST_LITERAL && operand->const_value) {
+            ConstValue v;
+            if (const_eval_unary(map_unary_op(op_token), operand->const_value, &v)) {
+                literal_set_value(operand, v);
+                return operand;
+            }
+        }
+
         /* create the unary AST node */
         AstNode *unary = ast_create_node(AST_UNARY_EXPR);
         if (!unary) {
@@ -1053,7 +1179,8 @@ AstNode *parse_primary(Parser *p, ParseError *err) {
                 ast_node_free(literal);
                 return NULL;
             }
-            literal->data.literal.value = token->lexeme ? strdup(token->lexeme) : NULL;
+            literal->data.literal.value = token_lexeme_dup(token);
+            literal_attach_const(literal);
             consume(p, token->type);
             return literal;
         }
@@ -1065,7 +1192,7 @@ AstNode *parse_primary(Parser *p, ParseError *err) {
                 if (err) create_parse_error(err, "out of memory creating identifier node", p);
                 return NULL;
             }
-            identifier->data.identifier.identifier = token->lexeme ? strdup(token->lexeme) : NULL;
+            identifier->data.identifier.identifier = (char *)token_lexeme_intern(token);
             consume(p, TOK_IDENTIFIER);
             return identifier;
         }
@@ -1197,8 +1324,8 @@ int parse_parameter_list(Parser *p, AstNode *func_decl, ParseError *err) {
             return 0;
         }
 
-        param->data.param.name = tok->lexeme ? strdup(tok->lexeme) : NULL;
-        if (tok->lexeme && !param->data.param.name) {
+        param->data.param.name = (char *)token_lexeme_intern(tok);
+        if (tok->start && !param->data.param.name) {
             ast_node_free(param);
             if (err) create_parse_error(err, "out of memory copying parameter name", p);
             return 0;
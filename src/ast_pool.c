@@ -0,0 +1,277 @@
+#include "ast_pool.h"
+#include "hash_map.h"
+#include "utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* -----------------------
+ * builder
+ *
+ * One post-order pass: children are emitted first so their indices
+ * are known, their index list is copied into the child array, and
+ * the parent record is appended last.
+ * --------------------- */
+
+typedef struct {
+    AstPoolNode *nodes;
+    uint32_t n_nodes, cap_nodes;
+    uint32_t *children;
+    uint32_t n_children, cap_children;
+    char *strings;
+    uint32_t n_strings, cap_strings;
+    HashMap *string_offsets; /* string -> offset + 1 (0 = not seen) */
+} PoolBuilder;
+
+static size_t pb_str_hash(void *key) {
+    const unsigned char *s = key;
+    unsigned long h = 5381;
+    int c;
+    while ((c = *s++)) h = ((h << 5) + h) + c;
+    return (size_t)h;
+}
+
+static int pb_str_cmp(void *a, void *b) {
+    return strcmp(a, b);
+}
+
+/* Intern s into the string table, returning its byte offset. */
+static uint32_t pb_add_string(PoolBuilder *w, const char *s) {
+    if (!s) return AST_POOL_NONE;
+
+    void *seen = hashmap_get(w->string_offsets, (void *)s, pb_str_hash, pb_str_cmp);
+    if (seen) return (uint32_t)((uintptr_t)seen - 1);
+
+    size_t len = strlen(s) + 1;
+    if (w->n_strings + len > w->cap_strings) {
+        while (w->n_strings + len > w->cap_strings) w->cap_strings *= 2;
+        w->strings = xrealloc(w->strings, w->cap_strings);
+    }
+    uint32_t off = w->n_strings;
+    memcpy(w->strings + off, s, len);
+    w->n_strings += (uint32_t)len;
+
+    hashmap_put(w->string_offsets, (void *)s, (void *)(uintptr_t)(off + 1),
+                pb_str_hash, pb_str_cmp);
+    return off;
+}
+
+static void pb_add_child(PoolBuilder *w, uint32_t child) {
+    if (w->n_children == w->cap_children) {
+        w->cap_children *= 2;
+        w->children = xrealloc(w->children, w->cap_children * sizeof(uint32_t));
+    }
+    w->children[w->n_children++] = child;
+}
+
+/* Append a finished record (children already appended). */
+static uint32_t pb_add_node(PoolBuilder *w, AstPoolNode rec) {
+    if (w->n_nodes == w->cap_nodes) {
+        w->cap_nodes *= 2;
+        w->nodes = xrealloc(w->nodes, w->cap_nodes * sizeof(AstPoolNode));
+    }
+    w->nodes[w->n_nodes] = rec;
+    return w->n_nodes++;
+}
+
+static uint32_t pb_emit(PoolBuilder *w, const AstNode *node);
+
+/* Emit node (NULL becomes an AST_POOL_NONE slot). */
+static uint32_t pb_emit_opt(PoolBuilder *w, const AstNode *node) {
+    return node ? pb_emit(w, node) : AST_POOL_NONE;
+}
+
+/* Post-order: children are emitted first so their indices are known,
+ * their index list is copied into the child array, and the record is
+ * appended last. tmp holds the child indices between the two steps. */
+static uint32_t pb_emit(PoolBuilder *w, const AstNode *node) {
+    AstPoolNode rec = {0};
+    rec.kind = (uint8_t)node->node_type;
+    rec.name = AST_POOL_NONE;
+
+    if (node->is_const_expr) rec.flags |= AST_POOL_F_CONST_EXPR;
+    if (node->const_value) {
+        rec.flags |= AST_POOL_F_HAS_CV;
+        uint64_t bits = 0;
+        memcpy(&bits, &node->const_value->int_val, sizeof bits);
+        rec.payload = bits;
+        rec.aux = (uint8_t)node->const_value->kind;
+    }
+
+    uint32_t tmp_fixed[8];
+    uint32_t *tmp = tmp_fixed;
+    uint32_t n_tmp = 0;
+    uint32_t *heap_tmp = NULL;
+
+    switch (node->node_type) {
+        case AST_PROGRAM: {
+            AstNodeArray *decls = node->data.program.decls;
+            size_t n = decls ? astnode_array_count(decls) : 0;
+            if (n > 8) tmp = heap_tmp = xmalloc(n * sizeof(uint32_t));
+            for (size_t i = 0; i < n; ++i)
+                tmp[n_tmp++] = pb_emit(w, astnode_array_get(decls, i));
+            break;
+        }
+        case AST_VARIABLE_DECLARATION:
+            rec.name = pb_add_string(w, node->data.variable_declaration.name);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.variable_declaration.type);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.variable_declaration.initializer);
+            break;
+        case AST_FUNCTION_DECLARATION: {
+            AstNodeArray *params = node->data.function_declaration.params;
+            size_t n = params ? astnode_array_count(params) : 0;
+            if (n + 2 > 8) tmp = heap_tmp = xmalloc((n + 2) * sizeof(uint32_t));
+            rec.name = pb_add_string(w, node->data.function_declaration.name);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.function_declaration.return_type);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.function_declaration.body);
+            for (size_t i = 0; i < n; ++i)
+                tmp[n_tmp++] = pb_emit(w, astnode_array_get(params, i));
+            break;
+        }
+        case AST_PARAM:
+            rec.name = pb_add_string(w, node->data.param.name);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.param.type);
+            break;
+        case AST_BLOCK: {
+            AstNodeArray *stmts = node->data.block.statements;
+            size_t n = stmts ? astnode_array_count(stmts) : 0;
+            if (n > 8) tmp = heap_tmp = xmalloc(n * sizeof(uint32_t));
+            for (size_t i = 0; i < n; ++i)
+                tmp[n_tmp++] = pb_emit(w, astnode_array_get(stmts, i));
+            break;
+        }
+        case AST_IF_STATEMENT:
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.if_statement.condition);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.if_statement.then_branch);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.if_statement.else_branch);
+            break;
+        case AST_WHILE_STATEMENT:
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.while_statement.condition);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.while_statement.body);
+            break;
+        case AST_FOR_STATEMENT:
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.for_statement.init);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.for_statement.condition);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.for_statement.post);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.for_statement.body);
+            break;
+        case AST_RETURN_STATEMENT:
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.return_statement.expression);
+            break;
+        case AST_BREAK_STATEMENT:
+        case AST_CONTINUE_STATEMENT:
+            break;
+        case AST_EXPR_STATEMENT:
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.expr_statement.expression);
+            break;
+        case AST_LITERAL:
+            rec.name = pb_add_string(w, node->data.literal.value);
+            rec.aux = (uint8_t)node->data.literal.type;
+            break;
+        case AST_IDENTIFIER:
+            rec.name = pb_add_string(w, node->data.identifier.identifier);
+            break;
+        case AST_BINARY_EXPR:
+            rec.op = (uint8_t)node->data.binary_expr.op;
+            tmp[n_tmp++] = pb_emit(w, node->data.binary_expr.left);
+            tmp[n_tmp++] = pb_emit(w, node->data.binary_expr.right);
+            break;
+        case AST_UNARY_EXPR:
+            rec.op = (uint8_t)node->data.unary_expr.op;
+            tmp[n_tmp++] = pb_emit(w, node->data.unary_expr.expr);
+            break;
+        case AST_POSTFIX_EXPR:
+            rec.op = (uint8_t)node->data.postfix_expr.op;
+            tmp[n_tmp++] = pb_emit(w, node->data.postfix_expr.expr);
+            break;
+        case AST_ASSIGNMENT_EXPR:
+            rec.op = (uint8_t)node->data.assignment_expr.op;
+            tmp[n_tmp++] = pb_emit(w, node->data.assignment_expr.lvalue);
+            tmp[n_tmp++] = pb_emit(w, node->data.assignment_expr.rvalue);
+            break;
+        case AST_CALL_EXPR: {
+            AstNodeArray *args = node->data.call_expr.args;
+            size_t n = args ? astnode_array_count(args) : 0;
+            if (n + 1 > 8) tmp = heap_tmp = xmalloc((n + 1) * sizeof(uint32_t));
+            tmp[n_tmp++] = pb_emit(w, node->data.call_expr.callee);
+            for (size_t i = 0; i < n; ++i)
+                tmp[n_tmp++] = pb_emit(w, astnode_array_get(args, i));
+            break;
+        }
+        case AST_SUBSCRIPT_EXPR:
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.subscript_expr.target);
+            tmp[n_tmp++] = pb_emit_opt(w, node->data.subscript_expr.index);
+            break;
+        case AST_TYPE: {
+            const AstType *t = &node->data.ast_type;
+            size_t n_sizes = t->sizes ? astnode_array_count(t->sizes) : 0;
+            size_t n_params = t->param_types ? astnode_array_count(t->param_types) : 0;
+            if (n_sizes + n_params + 1 > 8)
+                tmp = heap_tmp = xmalloc((n_sizes + n_params + 1) * sizeof(uint32_t));
+
+            rec.name = pb_add_string(w, t->base_type);
+            if (t->base_is_const) rec.aux |= AST_POOL_T_CONST;
+            if (t->is_function) rec.aux |= AST_POOL_T_FUNCTION;
+            rec.payload = (uint64_t)(t->pre_stars & 0xFFFF)
+                        | (uint64_t)(t->post_stars & 0xFFFF) << 16
+                        | (uint64_t)(n_sizes & 0xFFFF) << 32
+                        | (uint64_t)(n_params & 0xFFFF) << 48;
+
+            tmp[n_tmp++] = pb_emit_opt(w, t->return_type);
+            for (size_t i = 0; i < n_sizes; ++i)
+                tmp[n_tmp++] = pb_emit_opt(w, astnode_array_get(t->sizes, i));
+            for (size_t i = 0; i < n_params; ++i)
+                tmp[n_tmp++] = pb_emit(w, astnode_array_get(t->param_types, i));
+            break;
+        }
+        case AST_INITIALIZER_LIST: {
+            AstNodeArray *elems = node->data.initializer_list.elements;
+            size_t n = elems ? astnode_array_count(elems) : 0;
+            if (n > 8) tmp = heap_tmp = xmalloc(n * sizeof(uint32_t));
+            for (size_t i = 0; i < n; ++i)
+                tmp[n_tmp++] = pb_emit(w, astnode_array_get(elems, i));
+            break;
+        }
+    }
+
+    rec.first_child = w->n_children;
+    rec.child_count = n_tmp;
+    for (uint32_t i = 0; i < n_tmp; ++i) pb_add_child(w, tmp[i]);
+    free(heap_tmp);
+
+    return pb_add_node(w, rec);
+}
+
+int ast_pool_build(AstPool *pool, const AstNode *root) {
+    if (!pool || !root) return -1;
+
+    PoolBuilder w = {0};
+    w.cap_nodes = 256;
+    w.nodes = xmalloc(w.cap_nodes * sizeof(AstPoolNode));
+    w.cap_children = 256;
+    w.children = xmalloc(w.cap_children * sizeof(uint32_t));
+    w.cap_strings = 1 << 12;
+    w.strings = xmalloc(w.cap_strings);
+    w.string_offsets = hashmap_create(64);
+
+    uint32_t root_index = pb_emit(&w, root);
+
+    hashmap_destroy(w.string_offsets, NULL, NULL);
+
+    pool->nodes = w.nodes;
+    pool->node_count = w.n_nodes;
+    pool->children = w.children;
+    pool->child_count = w.n_children;
+    pool->strings = w.strings;
+    pool->string_bytes = w.n_strings;
+    pool->root = root_index;
+    return 0;
+}
+
+void ast_pool_free(AstPool *pool) {
+    if (!pool) return;
+    free(pool->nodes);
+    free(pool->children);
+    free(pool->strings);
+    memset(pool, 0, sizeof *pool);
+}
@@ -0,0 +1,309 @@
+/* src/bench.c
+ *
+ * Front-end benchmark suite behind --bench in main.c. Synthesizes
+ * parameterized corpora in the input/lang.bnf grammar, runs each
+ * configuration through run_compiler_timed() with warmup and
+ * repetition, and reports per-phase throughput (MB/s and tokens/s)
+ * with min/median/stddev. An optional JSON report and a minimum
+ * parse-throughput threshold make it usable as a CI regression gate.
+ */
+
+#include "bench.h"
+#include "driver.h"
+#include "file.h"
+#include "lexer.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h> /* unlink */
+#include <fcntl.h>  /* mkstemp */
+
+#define BENCH_WARMUP 2
+#define BENCH_REPS 10
+
+/* -----------------------
+ * corpus generation
+ * --------------------- */
+
+typedef struct {
+    const char *name;
+    int functions;       /* top-level function count */
+    int expr_depth;      /* nesting depth of generated expressions */
+    int stmts_per_fn;    /* statements per function body */
+    int ident_density;   /* % of expression leaves that are identifiers */
+} BenchConfig;
+
+static const BenchConfig bench_configs[] = {
+    { "small",  8,   3,  8, 50 },
+    { "medium", 64,  5, 16, 60 },
+    { "large",  256, 6, 24, 70 },
+};
+
+/* Deterministic LCG so corpora are identical across runs/machines. */
+static unsigned long bench_rng_state;
+
+static unsigned bench_rng(unsigned bound) {
+    bench_rng_state = bench_rng_state * 6364136223846793005UL + 1442695040888963407UL;
+    return (unsigned)((bench_rng_state >> 33) % bound);
+}
+
+/* Growable text buffer for the generated source. */
+typedef struct {
+    char *buf;
+    size_t len, cap;
+} BenchBuf;
+
+static void bb_init(BenchBuf *b) {
+    b->cap = 1 << 16;
+    b->buf = malloc(b->cap);
+    if (!b->buf) { perror("malloc"); exit(EXIT_FAILURE); }
+    b->len = 0;
+    b->buf[0] = '\0';
+}
+
+static void bb_append(BenchBuf *b, const char *s) {
+    size_t add = strlen(s);
+    if (b->len + add + 1 > b->cap) {
+        while (b->len + add + 1 > b->cap) b->cap *= 2;
+        b->buf = realloc(b->buf, b->cap);
+        if (!b->buf) { perror("realloc"); exit(EXIT_FAILURE); }
+    }
+    memcpy(b->buf + b->len, s, add + 1);
+    b->len += add;
+}
+
+static void bb_appendf(BenchBuf *b, const char *fmt, ...) {
+    char tmp[128];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(tmp, sizeof tmp, fmt, ap);
+    va_end(ap);
+    bb_append(b, tmp);
+}
+
+static const char *bench_binops[] = { "+", "-", "*", "/", "%", "<", ">", "==", "!=", "&&", "||" };
+
+/* Expression of the given depth; leaves are identifiers (vN, up to
+ * n_vars of them) or integer literals per the configured density. */
+static void gen_expr(BenchBuf *b, const BenchConfig *cfg, int depth, int n_vars) {
+    if (depth <= 0) {
+        if (n_vars > 0 && (int)bench_rng(100) < cfg->ident_density)
+            bb_appendf(b, "v%u", bench_rng((unsigned)n_vars));
+        else
+            bb_appendf(b, "%u", bench_rng(1000));
+        return;
+    }
+    switch (bench_rng(4)) {
+        case 0: /* unary */
+            bb_append(b, "-");
+            gen_expr(b, cfg, depth - 1, n_vars);
+            break;
+        case 1: /* parenthesized */
+            bb_append(b, "(");
+            gen_expr(b, cfg, depth - 1, n_vars);
+            bb_append(b, ")");
+            break;
+        default: /* binary */
+            gen_expr(b, cfg, depth - 1, n_vars);
+            bb_appendf(b, " %s ", bench_binops[bench_rng(sizeof bench_binops / sizeof *bench_binops)]);
+            gen_expr(b, cfg, depth - 1, n_vars);
+            break;
+    }
+}
+
+/* One function: a run of variable declarations with initializer
+ * expressions, plus if/while statements wrapping assignments. */
+static void gen_function(BenchBuf *b, const BenchConfig *cfg, int index) {
+    bb_appendf(b, "fn fun%d(a: i32, p: i32*) -> i32 {\n", index); /* "fun" avoids the f32/f64 keywords */
+    int n_vars = 0;
+    for (int s = 0; s < cfg->stmts_per_fn; ++s) {
+        switch (bench_rng(4)) {
+            case 0:
+                if (n_vars > 0) {
+                    bb_append(b, "    if (");
+                    gen_expr(b, cfg, cfg->expr_depth > 2 ? 2 : cfg->expr_depth, n_vars);
+                    bb_appendf(b, ") { v%u = ", bench_rng((unsigned)n_vars));
+                    gen_expr(b, cfg, cfg->expr_depth, n_vars);
+                    bb_append(b, "; }\n");
+                    break;
+                }
+                /* fall through: need a variable first */
+            default:
+                bb_appendf(b, "    v%d: i32 = ", n_vars);
+                gen_expr(b, cfg, cfg->expr_depth, n_vars);
+                bb_append(b, ";\n");
+                n_vars++;
+                break;
+        }
+    }
+    bb_appendf(b, "    return v%u;\n}\n\n", n_vars > 0 ? bench_rng((unsigned)n_vars) : 0);
+}
+
+/* Write the corpus for cfg to a temp file; returns its path in
+ * path_out (caller unlinks) and the byte size, or -1 on failure. */
+static long gen_corpus(const BenchConfig *cfg, char *path_out, size_t path_cap) {
+    bench_rng_state = 0x9e3779b97f4a7c15UL; /* fixed seed per config run */
+
+    BenchBuf b;
+    bb_init(&b);
+    for (int i = 0; i < cfg->functions; ++i) gen_function(&b, cfg, i);
+
+    char template[] = "/tmp/benchsrc_XXXXXX";
+    int fd = mkstemp(template);
+    if (fd < 0) { perror("mkstemp"); free(b.buf); return -1; }
+    size_t written = 0;
+    while (written < b.len) {
+        ssize_t w = write(fd, b.buf + written, b.len - written);
+        if (w < 0) { perror("write"); close(fd); unlink(template); free(b.buf); return -1; }
+        written += (size_t)w;
+    }
+    close(fd);
+    snprintf(path_out, path_cap, "%s", template);
+    long bytes = (long)b.len;
+    free(b.buf);
+    return bytes;
+}
+
+/* Count tokens the way lex_source sees them (comments excluded). */
+static long count_tokens(const char *path) {
+    SourceFile sf;
+    if (source_file_open(&sf, path) != 0) return -1;
+    Lexer *lx = lexer_create(sf.data);
+    long n = 0;
+    Token tok;
+    do {
+        lexer_next(lx, &tok);
+        if (tok.type != TOK_COMMENT) n++;
+    } while (tok.type != TOK_EOF);
+    free_lexer(lx);
+    source_file_close(&sf);
+    return n;
+}
+
+/* -----------------------
+ * statistics
+ * --------------------- */
+
+typedef struct {
+    double min_ms, median_ms, stddev_ms;
+} PhaseStats;
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static PhaseStats phase_stats(double *samples, int n) {
+    qsort(samples, (size_t)n, sizeof(double), cmp_double);
+    PhaseStats st;
+    st.min_ms = samples[0];
+    st.median_ms = (n % 2) ? samples[n / 2]
+                           : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+    double mean = 0.0;
+    for (int i = 0; i < n; ++i) mean += samples[i];
+    mean /= n;
+    double var = 0.0;
+    for (int i = 0; i < n; ++i) var += (samples[i] - mean) * (samples[i] - mean);
+    st.stddev_ms = sqrt(var / n);
+    return st;
+}
+
+static double mb_per_s(long bytes, double ms) {
+    if (ms <= 0.0) return 0.0;
+    return ((double)bytes / (1024.0 * 1024.0)) / (ms / 1000.0);
+}
+
+static double tokens_per_s(long tokens, double ms) {
+    if (ms <= 0.0) return 0.0;
+    return (double)tokens / (ms / 1000.0);
+}
+
+static void report_phase(FILE *json, const char *config, const char *phase,
+                         PhaseStats st, long bytes, long tokens) {
+    printf("  %-6s min=%8.3fms median=%8.3fms stddev=%7.3fms  %8.2f MB/s  %12.0f tok/s\n",
+           phase, st.min_ms, st.median_ms, st.stddev_ms,
+           mb_per_s(bytes, st.median_ms), tokens_per_s(tokens, st.median_ms));
+    if (json) {
+        fprintf(json,
+                "{\"config\":\"%s\",\"phase\":\"%s\",\"min_ms\":%.4f,"
+                "\"median_ms\":%.4f,\"stddev_ms\":%.4f,\"mb_per_s\":%.3f,"
+                "\"tokens_per_s\":%.1f}\n",
+                config, phase, st.min_ms, st.median_ms, st.stddev_ms,
+                mb_per_s(bytes, st.median_ms), tokens_per_s(tokens, st.median_ms));
+    }
+}
+
+/* -----------------------
+ * driver
+ * --------------------- */
+
+int bench_run_all(const char *json_path, double min_parse_mbps) {
+    FILE *json = NULL;
+    if (json_path) {
+        json = fopen(json_path, "w");
+        if (!json) { perror("fopen"); return EXIT_FAILURE; }
+    }
+
+    int gate_failed = 0;
+    size_t n_configs = sizeof bench_configs / sizeof *bench_configs;
+
+    for (size_t c = 0; c < n_configs; ++c) {
+        const BenchConfig *cfg = &bench_configs[c];
+
+        char path[64];
+        long bytes = gen_corpus(cfg, path, sizeof path);
+        if (bytes < 0) { if (json) fclose(json); return EXIT_FAILURE; }
+        long tokens = count_tokens(path);
+
+        CompilerOptions opts = {0};
+        opts.filename = path;
+
+        double lex_ms[BENCH_REPS], parse_ms[BENCH_REPS],
+               sem_ms[BENCH_REPS], total_ms[BENCH_REPS];
+        int ok = 1;
+
+        for (int rep = -BENCH_WARMUP; rep < BENCH_REPS; ++rep) {
+            CompilerTimings t;
+            if (run_compiler_timed(&opts, &t) != EXIT_SUCCESS) {
+                fprintf(stderr, "bench: config '%s' failed to compile\n", cfg->name);
+                ok = 0;
+                break;
+            }
+            if (rep < 0) continue; /* warmup */
+            lex_ms[rep] = t.lex_ms;
+            parse_ms[rep] = t.parse_ms;
+            sem_ms[rep] = t.sem_ms;
+            total_ms[rep] = t.total_ms;
+        }
+        unlink(path);
+        if (!ok) { if (json) fclose(json); return EXIT_FAILURE; }
+
+        printf("bench %-6s  %d fns, depth %d, %ld bytes, %ld tokens (%d reps)\n",
+               cfg->name, cfg->functions, cfg->expr_depth, bytes, tokens, BENCH_REPS);
+
+        PhaseStats st_lex = phase_stats(lex_ms, BENCH_REPS);
+        PhaseStats st_parse = phase_stats(parse_ms, BENCH_REPS);
+        PhaseStats st_sem = phase_stats(sem_ms, BENCH_REPS);
+        PhaseStats st_total = phase_stats(total_ms, BENCH_REPS);
+
+        report_phase(json, cfg->name, "lex", st_lex, bytes, tokens);
+        report_phase(json, cfg->name, "parse", st_parse, bytes, tokens);
+        report_phase(json, cfg->name, "sem", st_sem, bytes, tokens);
+        report_phase(json, cfg->name, "total", st_total, bytes, tokens);
+
+        if (min_parse_mbps > 0.0 &&
+            mb_per_s(bytes, st_parse.median_ms) < min_parse_mbps) {
+            fprintf(stderr,
+                    "bench: config '%s' parse throughput %.2f MB/s below gate %.2f MB/s\n",
+                    cfg->name, mb_per_s(bytes, st_parse.median_ms), min_parse_mbps);
+            gate_failed = 1;
+        }
+    }
+
+    if (json) fclose(json);
+    return gate_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
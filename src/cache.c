@@ -0,0 +1,104 @@
+#include "cache.h"
+#include "type.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Entry format (text, one per content hash):
+ *
+ *   compcache 1
+ *   F <name> <type>
+ *   V <name> <type>
+ *
+ * The F/V lines mirror the Functions/Variables sections of
+ * scope_print(); replaying them reproduces the --sym-table output
+ * without rebuilding any Symbol or Type objects. */
+
+#define CACHE_MAGIC "compcache 1"
+
+unsigned long cache_hash_source(const char *data, size_t len) {
+    unsigned long h = 14695981039346656037UL;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211UL;
+    }
+    return h;
+}
+
+static void cache_entry_path(char *out, size_t cap,
+                             const char *dir, unsigned long hash) {
+    snprintf(out, cap, "%s/%016lx.sym", dir, hash);
+}
+
+bool cache_lookup(const char *dir, unsigned long hash, bool print_symbols) {
+    char path[4096];
+    cache_entry_path(path, sizeof path, dir, hash);
+
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+
+    char line[4096];
+    if (!fgets(line, sizeof line, f) ||
+        strncmp(line, CACHE_MAGIC, strlen(CACHE_MAGIC)) != 0) {
+        /* unknown/old format: treat as a miss and recompile */
+        fclose(f);
+        return false;
+    }
+
+    if (print_symbols) {
+        puts("=== Symbol Table === (cached)");
+        puts("globalScope");
+        /* two passes keep the Functions/Variables grouping of scope_print */
+        for (int pass = 0; pass < 2; ++pass) {
+            char tag = pass == 0 ? 'F' : 'V';
+            printf("  %s:\n", pass == 0 ? "Functions" : "Variables");
+            rewind(f);
+            fgets(line, sizeof line, f); /* skip magic */
+            while (fgets(line, sizeof line, f)) {
+                if (line[0] != tag || line[1] != ' ') continue;
+                char *name = line + 2;
+                char *type = strchr(name, ' ');
+                if (!type) continue;
+                *type++ = '\0';
+                printf("    %s : %s", name, type); /* type keeps its '\n' */
+            }
+        }
+    }
+
+    fclose(f);
+    return true;
+}
+
+/* Write every entry of table as a "<tag> <name> <type>" line. */
+static void cache_write_symbols(FILE *f, SymbolTable *table, char tag) {
+    SymbolTableIter it;
+    char *key;
+    Symbol *sym;
+    symbol_table_iter_init(&it, table);
+    while (symbol_table_iter_next(&it, &key, &sym)) {
+        char *type = sym && sym->sem_type ? type_to_string(sym->sem_type) : NULL;
+        fprintf(f, "%c %s %s\n", tag, key, type ? type : "<NULL-symbol>");
+        free(type);
+    }
+}
+
+void cache_store(const char *dir, unsigned long hash, const Scope *scope) {
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) return;
+
+    char path[4096], tmp[4096];
+    cache_entry_path(path, sizeof path, dir, hash);
+    snprintf(tmp, sizeof tmp, "%s.%d.tmp", path, getpid());
+
+    FILE *f = fopen(tmp, "w");
+    if (!f) return;
+
+    fprintf(f, "%s\n", CACHE_MAGIC);
+    cache_write_symbols(f, scope->functions, 'F');
+    cache_write_symbols(f, scope->variables, 'V');
+
+    if (fclose(f) != 0 || rename(tmp, path) != 0) unlink(tmp);
+}
@@ -4,8 +4,16 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
+#include <unistd.h>
 
+#include "arena.h"
+#include "ast_bin.h"
+#include "cache.h"
 #include "file.h"
+#include "global_symtab.h"
+#include "stats.h"
+#include "intern.h"
 #include "lexer.h"
 #include "parser.h"
 #include "ast_parse_statements.h"
@@ -33,24 +41,11 @@ static void timer_stop(Timer *t) {
 
 /* Print timings if user requested them */
 static void print_timings_if_requested(const CompilerOptions *opts,
-                                       const Timer *t_load,
-                                       const Timer *t_lex,
-                                       const Timer *t_parse,
-                                       const Timer *t_sem,
-                                       const Timer *t_total) {
+                                       const CompilerTimings *t) {
     if (!opts->show_time) return;
     fprintf(stderr,
             "Timings (ms): load=%.3f lex=%.3f parse=%.3f func-types=%.3f total=%.3f\n",
-            t_load->ms, t_lex->ms, t_parse->ms, t_sem->ms, t_total->ms);
-}
-
-/* Load source file into heap string (caller frees) */
-static char *load_source(const char *filename) {
-    const char *src = read_file(filename);
-    if (!src) return NULL;
-    char *buf = strdup(src);
-    free((char*)src);
-    return buf;
+            t->load_ms, t->lex_ms, t->parse_ms, t->sem_ms, t->total_ms);
 }
 
 /* Lex input into TokenArray. Returns 0 on success, non-zero on failure. */
@@ -60,77 +55,118 @@ static int lex_source(const char *code, TokenArray *out_tokens) {
 
     token_array_init(out_tokens);
     while (1) {
-        Token *tok = lexer_next(lx);
-        if (!tok) {
-            free_lexer(lx);
-            token_array_free(out_tokens);
-            return -1;
-        }
-        if (tok->type == TOK_COMMENT) {
-            free_token(tok);
-            continue;
-        }
-        if (tok->type == TOK_UNKNOWN) {
-            fprintf(stderr, "error: unknown token '%s' at line %d, column %d\n",
-                    tok->lexeme, tok->line, tok->col);
-            free_token(tok);
+        Token tok;
+        lexer_next(lx, &tok);
+        if (tok.type == TOK_COMMENT) continue;
+        if (tok.type == TOK_UNKNOWN) {
+            LineIndex li;
+            size_t line, col;
+            line_index_init(&li, code);
+            line_index_locate(&li, tok.start, &line, &col);
+            fprintf(stderr, "error: unknown token '%.*s' at line %zu, column %zu\n",
+                    (int)tok.len, tok.start, line, col);
+            line_index_free(&li);
             free_lexer(lx);
             token_array_free(out_tokens);
             return -1;
         }
 
         token_array_push(out_tokens, tok);
-        if (tok->type == TOK_EOF) break;
+        if (tok.type == TOK_EOF) break;
     }
     free_lexer(lx);
     return 0;
 }
 
-/* The public driver function */
-int run_compiler_once(const CompilerOptions *opts) {
+/* Daemon mode keeps one arena alive across requests and rewinds it
+ * instead of destroying it, so repeat compiles hit already-mapped,
+ * already-warm blocks. NULL outside daemon mode. */
+static Arena *g_daemon_arena = NULL;
+
+/* Compile one file: load, lex, parse, analyze. Fills *times. */
+static int compile_one(const CompilerOptions *opts, const char *filename,
+                       CompilerTimings *times) {
     Timer t_total, t_load = {0}, t_lex = {0}, t_parse = {0}, t_sem = {0};
     int exit_code = EXIT_FAILURE;
     timer_start(&t_total);
 
-    char *code = NULL;
+    stats_reset();
+
+    /* All tokens, AST nodes, types and their strings for this compile
+     * come out of one arena, torn down in a single free at the end
+     * (or rewound for reuse when the daemon owns it). */
+    Arena *arena = g_daemon_arena ? g_daemon_arena : arena_create(0);
+    if (arena == g_daemon_arena) arena_reset(arena);
+    arena_set_current(arena);
+
+    SourceFile source = {0};
     TokenArray tokens;
     bool lex_ok = false;
+    Lexer *lexer = NULL;
     Parser *parser = NULL;
     AstNode *program = NULL;
     ParseError perr = {0};
 
-    /* load */
+    /* load: the lexer reads the mapped (or fallback-read) buffer in place */
+    stats_set_phase(STATS_PHASE_LOAD);
     timer_start(&t_load);
-    code = load_source(opts->filename);
-    timer_stop(&t_load);
-
-    if (!code) {
-        fprintf(stderr, "error: failed to read '%s'\n", opts->filename);
+    if (source_file_open(&source, filename) != 0) {
+        timer_stop(&t_load);
+        fprintf(stderr, "error: failed to read '%s'\n", filename);
         goto finish;
     }
+    timer_stop(&t_load);
 
-    /* lex */
-    timer_start(&t_lex);
-    if (lex_source(code, &tokens) != 0) {
-        fprintf(stderr, "error: lexing failed\n");
-        goto finish;
+    /* cache: on a content-hash hit the remaining phases are skipped and
+     * the recorded symbol table is replayed */
+    unsigned long src_hash = 0;
+    if (opts->cache_dir) {
+        src_hash = cache_hash_source(source.data, source.len);
+        if (cache_lookup(opts->cache_dir, src_hash, opts->show_symbol_table)) {
+            exit_code = EXIT_SUCCESS;
+            goto finish;
+        }
     }
-    lex_ok = true;
-    timer_stop(&t_lex);
 
-    if (opts->dump_tokens) {
-        for (size_t i = 0; i < tokens.size; ++i) print_token_colored(tokens.data[i]);
-    }
+    if (opts->stream) {
+        /* fused lex+parse: the parser pulls tokens from the lexer on
+           demand, so parsing starts immediately and no TokenArray is
+           ever materialized (unknown tokens surface as parse errors) */
+        stats_set_phase(STATS_PHASE_PARSE);
+        timer_start(&t_parse);
+        lexer = lexer_create(source.data);
+        parser = parser_create_streaming(lexer, filename);
+        program = parse_program(parser, &perr);
+        timer_stop(&t_parse);
+    } else {
+        /* lex */
+        stats_set_phase(STATS_PHASE_LEX);
+        timer_start(&t_lex);
+        if (lex_source(source.data, &tokens) != 0) {
+            fprintf(stderr, "error: lexing failed\n");
+            goto finish;
+        }
+        lex_ok = true;
+        timer_stop(&t_lex);
 
-    /* parse */
-    timer_start(&t_parse);
-    parser = parser_create(tokens, opts->filename);
-    program = parse_program(parser, &perr);
-    timer_stop(&t_parse);
+        if (opts->dump_tokens) {
+            dump_tokens_colored_fp(stdout, tokens.data, tokens.size, source.data);
+        }
+        if (opts->tokens_bin) {
+            dump_tokens_bin_file(opts->tokens_bin, tokens.data, tokens.size,
+                                 source.data);
+        }
+
+        /* parse */
+        stats_set_phase(STATS_PHASE_PARSE);
+        timer_start(&t_parse);
+        parser = parser_create(tokens, filename, source.data);
+        program = parse_program(parser, &perr);
+        timer_stop(&t_parse);
+    }
 
     if (perr.message) {
         print_parse_error(&perr);
-        free(perr.message);
         goto finish;
     }
 
@@ -139,7 +175,16 @@ int run_compiler_once(const CompilerOptions *opts) {
         print_ast(program, 0);
     }
 
+    if (opts->emit_ast_bin) {
+        if (ast_bin_write(program, opts->emit_ast_bin) != 0) {
+            fprintf(stderr, "error: failed to write AST to '%s'\n",
+                    opts->emit_ast_bin);
+            goto finish;
+        }
+    }
+
     /* semantics: collect function signatures (symbol table construction) */
+    stats_set_phase(STATS_PHASE_SEM);
     timer_start(&t_sem);
     {
         Scope global_scope = {0};
@@ -149,6 +194,23 @@ int run_compiler_once(const CompilerOptions *opts) {
             free_scope_maps(&global_scope); /* optional; safe if implemented */
             goto finish;
         }
+        /* multi-file runs publish signatures into the process-wide
+         * table so later whole-program passes can resolve across files */
+        if (global_symtab_enabled()) {
+            SymbolTableIter it;
+            char *key;
+            Symbol *sym;
+            symbol_table_iter_init(&it, global_scope.functions);
+            while (symbol_table_iter_next(&it, &key, &sym)) {
+                if (!global_symtab_publish(key, sym->sem_type)) {
+                    fprintf(stderr, "error: function '%s' already defined in another file\n",
+                            key);
+                    free_scope_maps(&global_scope);
+                    goto finish;
+                }
+            }
+        }
+
         if(opts->show_symbol_table){
             puts("=== Symbol Table ===");
             scope_print(&global_scope);
@@ -159,6 +221,21 @@ int run_compiler_once(const CompilerOptions *opts) {
         }
         
 
+        if (opts->analyze_bodies) {
+            /* phase two: bodies are independent once the signatures are
+             * in, so they fan out across the worker pool */
+            if (semantic_analysis_program(&global_scope, &program->data.program,
+                                          opts->jobs) != 0) {
+                fprintf(stderr, "error: semantic analysis failed\n");
+                free_scope_maps(&global_scope);
+                goto finish;
+            }
+        }
+
+        if (opts->cache_dir) {
+            cache_store(opts->cache_dir, src_hash, &global_scope);
+        }
+
         /* free symbol maps now; if you need them later, don't free here */
         free_scope_maps(&global_scope);
     }
@@ -169,15 +246,192 @@ int run_compiler_once(const CompilerOptions *opts) {
 finish:
     if (program) ast_node_free(program);
     if (parser) parser_free(parser);
+    if (lexer) free_lexer(lexer);
     if (lex_ok) token_array_free(&tokens);
-    if (code) free(code);
+    source_file_close(&source);
+
+    stats_set_phase(STATS_PHASE_NONE);
+    if (opts->show_stats) stats_report(stderr, filename);
+    if (opts->show_mem_stats) stats_report_mem(stderr, filename);
+
+    intern_reset();     /* canonical strings live in the arena below */
+    type_table_reset(); /* ditto the canonical types */
+    arena_set_current(NULL);
+    if (arena != g_daemon_arena) arena_destroy(arena);
 
     timer_stop(&t_total);
-    print_timings_if_requested(opts, &t_load, &t_lex, &t_parse, &t_sem, &t_total);
+    times->load_ms  = t_load.ms;
+    times->lex_ms   = t_lex.ms;
+    times->parse_ms = t_parse.ms;
+    times->sem_ms   = t_sem.ms;
+    times->total_ms = t_total.ms;
     return exit_code;
 }
 
-/* small wrapper kept for API parity */
+/* Single-file entry point (also used by the test suite). */
+int run_compiler_once(const CompilerOptions *opts) {
+    CompilerTimings t = {0};
+    int rc = compile_one(opts, opts->filename, &t);
+    print_timings_if_requested(opts, &t);
+    return rc;
+}
+
+/* Single-file run that hands the phase timings back to the caller. */
+int run_compiler_timed(const CompilerOptions *opts, CompilerTimings *times) {
+    CompilerTimings t = {0};
+    int rc = compile_one(opts, opts->filename, &t);
+    if (times) *times = t;
+    return rc;
+}
+
+/* -------------------------
+ * Parallel multi-file mode
+ * ------------------------- */
+
+typedef struct {
+    const CompilerOptions *opts;
+    size_t next;            /* index of the next unclaimed file */
+    pthread_mutex_t lock;   /* guards next, agg and failures */
+    CompilerTimings agg;
+    int failures;
+} FileQueue;
+
+static void *compile_worker(void *arg) {
+    FileQueue *q = arg;
+    for (;;) {
+        pthread_mutex_lock(&q->lock);
+        size_t i = q->next++;
+        pthread_mutex_unlock(&q->lock);
+        if (i >= q->opts->num_files) break;
+
+        CompilerTimings t = {0};
+        int rc = compile_one(q->opts, q->opts->filenames[i], &t);
+
+        pthread_mutex_lock(&q->lock);
+        q->agg.load_ms  += t.load_ms;
+        q->agg.lex_ms   += t.lex_ms;
+        q->agg.parse_ms += t.parse_ms;
+        q->agg.sem_ms   += t.sem_ms;
+        q->agg.total_ms += t.total_ms;
+        if (rc != EXIT_SUCCESS) q->failures++;
+        pthread_mutex_unlock(&q->lock);
+    }
+    return NULL;
+}
+
+/* Compile opts->filenames with a pool of worker threads sharing one
+ * process (lexer tables built once, no per-file process startup).
+ * Timings are summed over files and printed as one report. */
+static int run_compiler_parallel(const CompilerOptions *opts) {
+    lexer_init_tables(); /* warm the shared read-only tables up front */
+    global_symtab_init(); /* cross-file signatures, sharded per key hash */
+
+    size_t jobs = opts->jobs;
+    if (jobs == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = n > 0 ? (size_t)n : 1;
+    }
+    if (jobs > opts->num_files) jobs = opts->num_files;
+
+    FileQueue q = {0};
+    q.opts = opts;
+    pthread_mutex_init(&q.lock, NULL);
+
+    pthread_t *threads = malloc(jobs * sizeof(*threads));
+    if (!threads) {
+        perror("malloc");
+        pthread_mutex_destroy(&q.lock);
+        return EXIT_FAILURE;
+    }
+
+    size_t started = 0;
+    for (; started < jobs; ++started) {
+        if (pthread_create(&threads[started], NULL, compile_worker, &q) != 0) {
+            perror("pthread_create");
+            break;
+        }
+    }
+    for (size_t i = 0; i < started; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&q.lock);
+    global_symtab_destroy();
+
+    if (started == 0) return EXIT_FAILURE;
+
+    print_timings_if_requested(opts, &q.agg);
+    if (q.failures) {
+        fprintf(stderr, "error: %d of %zu files failed to compile\n",
+                q.failures, opts->num_files);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/* Dispatch: one file runs inline, several run on the worker pool. */
 int run_compiler(const CompilerOptions *opts) {
+    if (opts->num_files > 1) return run_compiler_parallel(opts);
     return run_compiler_once(opts);
+}
+
+/* -------------------------
+ * Daemon mode
+ * ------------------------- */
+
+/* One request per stdin line: per-compile flags followed by a file path,
+ * e.g. "--ast --sem src/main.x". Flags not present fall back to the
+ * options the daemon was launched with, so "--cache dir --daemon" caches
+ * every request. Each compile is answered with "done <rc>" on stdout so
+ * the client can delimit responses. "quit" or EOF ends the loop. */
+static int daemon_handle_line(const CompilerOptions *base, char *line) {
+    CompilerOptions opts = *base;
+    opts.filename = NULL;
+
+    for (char *word = strtok(line, " \t"); word; word = strtok(NULL, " \t")) {
+        if      (strcmp(word, "--tokens") == 0)    opts.dump_tokens = true;
+        else if (strcmp(word, "--ast") == 0)       opts.dump_ast = true;
+        else if (strcmp(word, "--time") == 0)      opts.show_time = true;
+        else if (strcmp(word, "--stream") == 0)    opts.stream = true;
+        else if (strcmp(word, "--sem") == 0)       opts.analyze_bodies = true;
+        else if (strcmp(word, "--sym-table") == 0) opts.show_symbol_table = true;
+        else if (strcmp(word, "--type-tree") == 0) opts.show_hierarchical_types = true;
+        else if (strcmp(word, "--stats") == 0)     opts.show_stats = true;
+        else if (word[0] == '-') {
+            fprintf(stderr, "daemon: unknown option '%s'\n", word);
+            return EXIT_FAILURE;
+        } else {
+            opts.filename = word;
+        }
+    }
+
+    if (!opts.filename) {
+        fprintf(stderr, "daemon: no file in request\n");
+        return EXIT_FAILURE;
+    }
+    return run_compiler_once(&opts);
+}
+
+/* Stay resident and serve compile requests from stdin. Process startup,
+ * the lexer dispatch tables and the arena's memory blocks are paid once
+ * and reused for every request, instead of once per exec. */
+int run_compiler_daemon(const CompilerOptions *base) {
+    lexer_init_tables();
+    g_daemon_arena = arena_create(0);
+
+    char line[4096];
+    while (fgets(line, sizeof line, stdin)) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0] == '\0') continue;
+        if (strcmp(line, "quit") == 0 || strcmp(line, "exit") == 0) break;
+
+        int rc = daemon_handle_line(base, line);
+        printf("done %d\n", rc);
+        fflush(stdout);
+        fflush(stderr);
+    }
+
+    arena_destroy(g_daemon_arena);
+    g_daemon_arena = NULL;
+    return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -1,5 +1,11 @@
 #include "file.h"
 
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 char *read_file(const char *filename) {
     FILE *file = fopen(filename, "rb");  // Open in binary mode
     if (!file) {
@@ -39,4 +45,55 @@ void free_file_content(char *content) {
     if (content) {
         free(content);
     }
-}
\ No newline at end of file
+}
+
+/* Open a source file for lexing, preferring a read-only mmap so the
+ * text is never copied and the OS page cache does the work.
+ *
+ * The lexer requires NUL-terminated input. A private file mapping
+ * zero-fills the tail of its final partial page, which provides the
+ * terminator for free — but only when the file size is not an exact
+ * multiple of the page size. In that case (and for pipes, devices and
+ * empty files) we fall back to the fread path, which appends the NUL
+ * itself.
+ */
+int source_file_open(SourceFile *sf, const char *filename) {
+    sf->data = NULL;
+    sf->len = 0;
+    sf->is_mmap = 0;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        long page = sysconf(_SC_PAGESIZE);
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+            st.st_size > 0 && page > 0 && (st.st_size % page) != 0) {
+            void *map = mmap(NULL, (size_t)st.st_size, PROT_READ,
+                             MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                close(fd);
+                sf->data = map;
+                sf->len = (size_t)st.st_size;
+                sf->is_mmap = 1;
+                return 0;
+            }
+        }
+        close(fd);
+    }
+
+    /* fallback: buffered read with explicit NUL terminator */
+    char *buf = read_file(filename);
+    if (!buf) return -1;
+    sf->data = buf;
+    sf->len = strlen(buf);
+    return 0;
+}
+
+void source_file_close(SourceFile *sf) {
+    if (!sf || !sf->data) return;
+    if (sf->is_mmap) munmap(sf->data, sf->len);
+    else free(sf->data);
+    sf->data = NULL;
+    sf->len = 0;
+    sf->is_mmap = 0;
+}
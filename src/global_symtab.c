@@ -0,0 +1,107 @@
+#include "global_symtab.h"
+#include "utils.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    SymbolTable *table;
+    pthread_mutex_t lock;
+} GlobalShard;
+
+static GlobalShard g_shards[GLOBAL_SYMTAB_SHARDS];
+static int g_enabled;
+
+/* Content-based hashing: shard keys are plain heap strings, not
+ * interned, so the default identity compare does not apply. */
+static size_t gs_str_hash(char *s) {
+    const unsigned char *p = (const unsigned char *)s;
+    unsigned long h = 5381;
+    int c;
+    while ((c = *p++)) h = ((h << 5) + h) + c;
+    return (size_t)h;
+}
+
+static int gs_str_cmp(char *a, char *b) {
+    return strcmp(a, b);
+}
+
+static void gs_free_symbol(Symbol *sym) {
+    if (!sym) return;
+    free(sym->name);
+    type_free(sym->sem_type); /* heap clone; destroy runs with no arena */
+    free(sym);
+}
+
+void global_symtab_init(void) {
+    if (g_enabled) return;
+    for (size_t i = 0; i < GLOBAL_SYMTAB_SHARDS; ++i) {
+        g_shards[i].table = symbol_table_create(0);
+        g_shards[i].table->hash = gs_str_hash;
+        g_shards[i].table->cmp = gs_str_cmp;
+        g_shards[i].table->free_key = NULL; /* key is sym->name, freed once */
+        g_shards[i].table->free_value = gs_free_symbol;
+        pthread_mutex_init(&g_shards[i].lock, NULL);
+    }
+    g_enabled = 1;
+}
+
+void global_symtab_destroy(void) {
+    if (!g_enabled) return;
+    for (size_t i = 0; i < GLOBAL_SYMTAB_SHARDS; ++i) {
+        symbol_table_destroy(g_shards[i].table);
+        g_shards[i].table = NULL;
+        pthread_mutex_destroy(&g_shards[i].lock);
+    }
+    g_enabled = 0;
+}
+
+int global_symtab_enabled(void) {
+    return g_enabled;
+}
+
+static GlobalShard *gs_shard_for(const char *name) {
+    return &g_shards[gs_str_hash((char *)name) % GLOBAL_SYMTAB_SHARDS];
+}
+
+bool global_symtab_publish(const char *name, const Type *type) {
+    if (!g_enabled || !name) return false;
+
+    GlobalShard *shard = gs_shard_for(name);
+    pthread_mutex_lock(&shard->lock);
+
+    if (symbol_table_get_raw(shard->table, name)) {
+        pthread_mutex_unlock(&shard->lock);
+        return false; /* already defined in another file */
+    }
+
+    Symbol *sym = xmalloc(sizeof *sym);
+    sym->name = xstrdup(name);
+    sym->sem_type = type_clone_heap(type);
+    sym->is_const_expr = 0;
+
+    bool ok = symbol_table_put_raw(shard->table, sym->name, sym);
+    pthread_mutex_unlock(&shard->lock);
+
+    if (!ok) gs_free_symbol(sym);
+    return ok;
+}
+
+Symbol *global_symtab_lookup(const char *name) {
+    if (!g_enabled || !name) return NULL;
+
+    GlobalShard *shard = gs_shard_for(name);
+    pthread_mutex_lock(&shard->lock);
+    Symbol *sym = symbol_table_get_raw(shard->table, name);
+    pthread_mutex_unlock(&shard->lock);
+    return sym;
+}
+
+size_t global_symtab_size(void) {
+    if (!g_enabled) return 0;
+    size_t n = 0;
+    for (size_t i = 0; i < GLOBAL_SYMTAB_SHARDS; ++i)
+        n += symbol_table_size(g_shards[i].table);
+    return n;
+}
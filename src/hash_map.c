@@ -1,23 +1,40 @@
 #include "hash_map.h"
+#include "stats.h"
 #include <stdlib.h>
+#include <string.h>
+
+/* Slot states encoded in the cached hash field. */
+#define SLOT_EMPTY 0
+#define SLOT_TOMB  1
+
+/* Grow once live + tombstone slots pass 7/8 of capacity. */
+#define MAP_MAX_LOAD(cap) ((cap) - (cap) / 8)
+
+static size_t round_up_pow2(size_t n) {
+    size_t cap = 16;
+    while (cap < n) cap <<= 1;
+    return cap;
+}
+
+/* Remap real hashes above the reserved state values. */
+static size_t slot_hash(size_t h) {
+    return h < 2 ? h + 2 : h;
+}
 
 HashMap* hashmap_create(size_t bucket_count) {
-    if (bucket_count == 0) bucket_count = 16; // default to 16 buckets
+    if (bucket_count == 0) bucket_count = 16;
     HashMap *map = malloc(sizeof(HashMap));
     if (!map) return NULL;
 
-    map->buckets = malloc(bucket_count * sizeof(DynArray));
-    if (!map->buckets) {
+    map->capacity = round_up_pow2(bucket_count);
+    map->slots = calloc(map->capacity, sizeof(HashSlot));
+    if (!map->slots) {
         free(map);
         return NULL;
     }
 
-    for (size_t i = 0; i < bucket_count; i++) {
-        dynarray_init(&map->buckets[i], sizeof(KeyValue));
-    }
-
-    map->bucket_count = bucket_count;
     map->size = 0;
+    map->used = 0;
     return map;
 }
 
@@ -28,19 +45,74 @@ void hashmap_destroy(
 ) {
     if (!map) return;
 
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        DynArray *bucket = &map->buckets[i];
-        for (size_t j = 0; j < bucket->count; j++) {
-            KeyValue *kv = (KeyValue*)dynarray_get(bucket, j);
-            if (free_key) free_key(kv->key);
-            if (free_value) free_value(kv->value);
-        }
-        dynarray_free(bucket);
+    for (size_t i = 0; i < map->capacity; i++) {
+        HashSlot *slot = &map->slots[i];
+        if (!hashslot_occupied(slot)) continue;
+        if (free_key) free_key(slot->key);
+        if (free_value) free_value(slot->value);
     }
-    free(map->buckets);
+    free(map->slots);
     free(map);
 }
 
+/* Reallocate the slot array at new_capacity (a power of two) and
+ * reinsert live entries using their cached hashes. Tombstones are
+ * dropped in the process. */
+static bool hashmap_resize(HashMap *map, size_t new_capacity) {
+    HashSlot *old_slots = map->slots;
+    size_t old_capacity = map->capacity;
+
+    HashSlot *slots = calloc(new_capacity, sizeof(HashSlot));
+    if (!slots) return false;
+
+    size_t mask = new_capacity - 1;
+    for (size_t i = 0; i < old_capacity; i++) {
+        HashSlot *slot = &old_slots[i];
+        if (!hashslot_occupied(slot)) continue;
+        size_t j = slot->hash & mask;
+        while (slots[j].hash != SLOT_EMPTY) j = (j + 1) & mask;
+        slots[j] = *slot;
+    }
+
+    free(old_slots);
+    map->slots = slots;
+    map->capacity = new_capacity;
+    map->used = map->size;
+    return true;
+}
+
+/* Linear probe for key. Returns the live slot holding it, or NULL; if
+ * insert_pos is non-NULL it receives the first reusable slot (tombstone
+ * or empty) on the probe path for a subsequent insert. */
+static HashSlot *hashmap_find(
+    HashMap *map,
+    void *key,
+    size_t h,
+    int (*cmp)(void*, void*),
+    HashSlot **insert_pos
+) {
+    size_t mask = map->capacity - 1;
+    HashSlot *reuse = NULL;
+
+    for (size_t i = h & mask; ; i = (i + 1) & mask) {
+        HashSlot *slot = &map->slots[i];
+        STATS_INC(hashmap_probes);
+        if (i != (h & mask)) STATS_INC(hashmap_collisions);
+        if (slot->hash == SLOT_EMPTY) {
+            if (insert_pos) *insert_pos = reuse ? reuse : slot;
+            return NULL;
+        }
+        if (slot->hash == SLOT_TOMB) {
+            if (!reuse) reuse = slot;
+            continue;
+        }
+        if (slot->hash == h && cmp(slot->key, key) == 0) {
+            if (insert_pos) *insert_pos = slot;
+            return slot;
+        }
+    }
+}
+
 bool hashmap_put(
     HashMap* map,
     void* key,
@@ -50,25 +122,23 @@ bool hashmap_put(
 ) {
     if (!map || !key || !hash || !cmp) return false;
 
-    size_t bucket_index = hash(key) % map->bucket_count;
-    DynArray *bucket = &map->buckets[bucket_index];
-
-    // Check if key already exists
-    for (size_t i = 0; i < bucket->count; i++) {
-        KeyValue *kv = (KeyValue*)dynarray_get(bucket, i);
-        if (cmp(kv->key, key) == 0) {
-            // Update existing value
-            kv->value = value;
-            return true;
-        }
+    if (map->used + 1 > MAP_MAX_LOAD(map->capacity)) {
+        if (!hashmap_resize(map, map->capacity * 2)) return false;
     }
 
-    // Insert new key-value pair
-    KeyValue kv = {key, value};
-    if (dynarray_push_value(bucket, &kv) != 0) {
-        return false; // OOM
+    size_t h = slot_hash(hash(key));
+    HashSlot *insert_pos = NULL;
+    HashSlot *slot = hashmap_find(map, key, h, cmp, &insert_pos);
+    if (slot) {
+        /* Update existing value (original key is kept) */
+        slot->value = value;
+        return true;
     }
-    
+
+    if (insert_pos->hash == SLOT_EMPTY) map->used++;
+    insert_pos->hash = h;
+    insert_pos->key = key;
+    insert_pos->value = value;
     map->size++;
     return true;
 }
@@ -81,16 +151,9 @@ void* hashmap_get(
 ) {
     if (!map || !key || !hash || !cmp) return NULL;
 
-    size_t bucket_index = hash(key) % map->bucket_count;
-    DynArray *bucket = &map->buckets[bucket_index];
-
-    for (size_t i = 0; i < bucket->count; i++) {
-        KeyValue *kv = (KeyValue*)dynarray_get(bucket, i);
-        if (cmp(kv->key, key) == 0) {
-            return kv->value; // Found
-        }
-    }
-    return NULL; // Not found
+    size_t h = slot_hash(hash(key));
+    HashSlot *slot = hashmap_find(map, key, h, cmp, NULL);
+    return slot ? slot->value : NULL;
 }
 
 bool hashmap_remove(
@@ -103,23 +166,19 @@ bool hashmap_remove(
 ) {
     if (!map || !key || !hash || !cmp) return false;
 
-    size_t bucket_index = hash(key) % map->bucket_count;
-    DynArray *bucket = &map->buckets[bucket_index];
+    size_t h = slot_hash(hash(key));
+    HashSlot *slot = hashmap_find(map, key, h, cmp, NULL);
+    if (!slot) return false;
 
-    for (size_t i = 0; i < bucket->count; i++) {
-        KeyValue *kv = (KeyValue*)dynarray_get(bucket, i);
-        if (cmp(kv->key, key) == 0) {
-            // Free key and value if provided
-            if (free_key) free_key(kv->key);
-            if (free_value) free_value(kv->value);
+    if (free_key) free_key(slot->key);
+    if (free_value) free_value(slot->value);
 
-            // Remove from bucket
-            remove_element(bucket, i);
-            map->size--;
-            return true; // Removed
-        }
-    }
-    return false; // Not found
+    /* tombstone keeps later probe chains intact */
+    slot->hash = SLOT_TOMB;
+    slot->key = NULL;
+    slot->value = NULL;
+    map->size--;
+    return true;
 }
 
 bool hashmap_rehash(
@@ -128,41 +187,13 @@ bool hashmap_rehash(
     size_t (*hash)(void*),
     int (*cmp)(void*, void*)
 ) {
-    if (!map || new_bucket_count == 0 || !hash || !cmp) return false;
-
-    DynArray *new_buckets = malloc(new_bucket_count * sizeof(DynArray));
-    if (!new_buckets) return false;
+    (void)hash;
+    (void)cmp; /* cached hashes make the callbacks unnecessary */
+    if (!map || new_bucket_count == 0) return false;
 
-    for (size_t i = 0; i < new_bucket_count; i++) {
-        dynarray_init(&new_buckets[i], sizeof(KeyValue));
-    }
-
-    // Reinsert all key-value pairs into new buckets
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        DynArray *bucket = &map->buckets[i];
-        for (size_t j = 0; j < bucket->count; j++) {
-            KeyValue *kv = (KeyValue*)dynarray_get(bucket, j);
-            size_t new_index = hash(kv->key) % new_bucket_count;
-            if (dynarray_push_value(&new_buckets[new_index], kv) != 0) {
-                // Cleanup on failure
-                for (size_t k = 0; k < new_bucket_count; k++) {
-                    dynarray_free(&new_buckets[k]);
-                }
-                free(new_buckets);
-                return false; // OOM
-            }
-        }
-    }
-
-    // Free old buckets
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        dynarray_free(&map->buckets[i]);
-    }
-    free(map->buckets);
-
-    map->buckets = new_buckets;
-    map->bucket_count = new_bucket_count;
-    return true;
+    size_t new_capacity = round_up_pow2(new_bucket_count);
+    if (new_capacity < map->size * 2) new_capacity = round_up_pow2(map->size * 2);
+    return hashmap_resize(map, new_capacity);
 }
 
 void hashmap_foreach(
@@ -171,15 +202,12 @@ void hashmap_foreach(
 ) {
     if (!map || !callback) return;
 
-    for (size_t i = 0; i < map->bucket_count; i++) {
-        DynArray *bucket = &map->buckets[i];
-        for (size_t j = 0; j < bucket->count; j++) {
-            KeyValue *kv = (KeyValue*)dynarray_get(bucket, j);
-            callback(kv->key, kv->value);
-        }
+    for (size_t i = 0; i < map->capacity; i++) {
+        HashSlot *slot = &map->slots[i];
+        if (hashslot_occupied(slot)) callback(slot->key, slot->value);
     }
 }
 
 size_t hashmap_size(HashMap* map) {
     return map ? map->size : 0;
-}
\ No newline at end of file
+}
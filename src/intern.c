@@ -0,0 +1,100 @@
+#include "intern.h"
+#include "arena.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Each canonical string is laid out as { hash } { bytes... NUL } in the
+ * arena; the public pointer is the bytes, so the hash sits one header
+ * behind it. */
+typedef struct {
+    size_t hash;
+} InternHeader;
+
+typedef struct {
+    size_t hash;
+    const char *str; /* NULL = empty slot */
+} InternSlot;
+
+/* Thread-local like the current arena: one pool per driver worker. */
+static _Thread_local struct {
+    InternSlot *slots;
+    size_t capacity; /* power of two */
+    size_t count;
+} pool;
+
+#define INTERN_INITIAL_CAP 256
+
+static size_t str_hashn(const char *s, size_t n) {
+    unsigned long h = 5381;
+    for (size_t i = 0; i < n; i++)
+        h = ((h << 5) + h) + (unsigned char)s[i]; /* djb2 */
+    return (size_t)h;
+}
+
+static void intern_grow(size_t new_capacity) {
+    InternSlot *slots = calloc(new_capacity, sizeof(InternSlot));
+    if (!slots) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    size_t mask = new_capacity - 1;
+    for (size_t i = 0; i < pool.capacity; i++) {
+        InternSlot *slot = &pool.slots[i];
+        if (!slot->str) continue;
+        size_t j = slot->hash & mask;
+        while (slots[j].str) j = (j + 1) & mask;
+        slots[j] = *slot;
+    }
+    free(pool.slots);
+    pool.slots = slots;
+    pool.capacity = new_capacity;
+}
+
+const char *intern_strn(const char *s, size_t n) {
+    if (!s) return NULL;
+
+    if (pool.capacity == 0) intern_grow(INTERN_INITIAL_CAP);
+    else if (pool.count + 1 > pool.capacity - pool.capacity / 4)
+        intern_grow(pool.capacity * 2);
+
+    size_t h = str_hashn(s, n);
+    size_t mask = pool.capacity - 1;
+    size_t i = h & mask;
+    while (pool.slots[i].str) {
+        InternSlot *slot = &pool.slots[i];
+        if (slot->hash == h &&
+            strncmp(slot->str, s, n) == 0 && slot->str[n] == '\0') {
+            return slot->str; /* already canonical */
+        }
+        i = (i + 1) & mask;
+    }
+
+    InternHeader *hdr = arena_alloc_current(sizeof(InternHeader) + n + 1);
+    hdr->hash = h;
+    char *copy = (char *)(hdr + 1);
+    memcpy(copy, s, n);
+    copy[n] = '\0';
+
+    pool.slots[i].hash = h;
+    pool.slots[i].str = copy;
+    pool.count++;
+    return copy;
+}
+
+const char *intern_str(const char *s) {
+    if (!s) return NULL;
+    return intern_strn(s, strlen(s));
+}
+
+size_t intern_hash(const char *s) {
+    return ((const InternHeader *)s - 1)->hash;
+}
+
+void intern_reset(void) {
+    free(pool.slots);
+    pool.slots = NULL;
+    pool.capacity = 0;
+    pool.count = 0;
+}
@@ -1,17 +1,300 @@
 #include "lexer.h"
+#include "stats.h"
 #include <ctype.h>
 
-void compile_regex_patterns() {
+/* ---------------------------------------------------------------
+ * Table-driven DFA for the pattern-based tokens in tokens.def
+ * (TOK_FLOAT, TOK_INTEGER, TOK_IDENTIFIER).
+ *
+ * The regex patterns in tokens.def use a tiny subset of POSIX
+ * syntax: a leading '^', character classes like [a-zA-Z_], the
+ * escaped literal '\.', and the '+' / '*' quantifiers. That subset
+ * is compiled at startup into a single DFA transition table, so
+ * classifying a token is one pass over the input with no libc
+ * regex involvement. Longest match wins; ties go to the pattern
+ * listed first in tokens.def (FLOAT before INTEGER).
+ * --------------------------------------------------------------- */
+
+#define DFA_MAX_ITEMS   8   /* max class items per pattern */
+#define DFA_MAX_NFA     32  /* total NFA positions across all patterns */
+#define DFA_MAX_STATES  64  /* subset-construction DFA states */
+
+typedef enum {
+    QUANT_ONE,   /* exactly one */
+    QUANT_PLUS,  /* one or more */
+    QUANT_STAR   /* zero or more */
+} DfaQuant;
+
+/* One compiled "item" of a pattern: a character class + quantifier. */
+typedef struct {
+    unsigned char in_class[256];
+    DfaQuant quant;
+} DfaItem;
+
+/* A pattern is a linear chain of items (no alternation needed). */
+typedef struct {
+    TokenType type;
+    DfaItem items[DFA_MAX_ITEMS];
+    size_t n_items;
+} DfaPattern;
+
+typedef unsigned int NfaSet; /* bitset over NFA positions */
+
+static struct {
+    int initialized;
+
+    DfaPattern patterns[8];
+    size_t n_patterns;
+
+    /* flattened NFA positions: (pattern index, item index) */
+    size_t pat_of[DFA_MAX_NFA];
+    size_t item_of[DFA_MAX_NFA];
+    size_t pat_base[8];      /* first NFA position of each pattern */
+    size_t n_positions;
+
+    /* subset-construction result */
+    unsigned char trans[DFA_MAX_STATES][256]; /* 0 = dead state */
+    int accept[DFA_MAX_STATES];               /* TokenType or -1 */
+    size_t n_states;
+} dfa;
+
+/* Parse one pattern from tokens.def into class items. Returns 0 on
+ * success; anything outside the supported subset is a hard error
+ * (the pattern table is ours, so this means tokens.def changed in a
+ * way the DFA builder doesn't understand yet). */
+static int dfa_parse_pattern(const char *pattern, DfaPattern *out) {
+    const char *s = pattern;
+    out->n_items = 0;
+
+    if (*s == '^') s++;
+
+    while (*s) {
+        if (out->n_items >= DFA_MAX_ITEMS) return -1;
+        DfaItem *item = &out->items[out->n_items];
+        memset(item->in_class, 0, sizeof(item->in_class));
+
+        if (*s == '[') {
+            s++;
+            while (*s && *s != ']') {
+                unsigned char lo = (unsigned char)*s++;
+                if (*s == '-' && s[1] && s[1] != ']') {
+                    unsigned char hi = (unsigned char)s[1];
+                    for (int c = lo; c <= hi; c++) item->in_class[c] = 1;
+                    s += 2;
+                } else {
+                    item->in_class[lo] = 1;
+                }
+            }
+            if (*s != ']') return -1;
+            s++;
+        } else if (*s == '\\' && s[1]) {
+            item->in_class[(unsigned char)s[1]] = 1;
+            s += 2;
+        } else {
+            item->in_class[(unsigned char)*s] = 1;
+            s++;
+        }
+
+        if (*s == '+')      { item->quant = QUANT_PLUS; s++; }
+        else if (*s == '*') { item->quant = QUANT_STAR; s++; }
+        else                { item->quant = QUANT_ONE; }
+
+        out->n_items++;
+    }
+
+    return out->n_items > 0 ? 0 : -1;
+}
+
+/* Epsilon closure: from position (p,i), also reach any later items
+ * whose preceding items are all skippable (QUANT_STAR). */
+static NfaSet dfa_closure(NfaSet set) {
+    for (size_t pos = 0; pos < dfa.n_positions; pos++) {
+        if (!(set & (1u << pos))) continue;
+        size_t p = dfa.pat_of[pos];
+        size_t i = dfa.item_of[pos];
+        while (i < dfa.patterns[p].n_items &&
+               dfa.patterns[p].items[i].quant == QUANT_STAR) {
+            i++;
+            set |= 1u << (dfa.pat_base[p] + i);
+        }
+    }
+    return set;
+}
+
+/* A position past the last item of its pattern is accepting. */
+static int dfa_set_accept(NfaSet set) {
+    for (size_t p = 0; p < dfa.n_patterns; p++) {
+        size_t end_pos = dfa.pat_base[p] + dfa.patterns[p].n_items;
+        if (set & (1u << end_pos)) return (int)dfa.patterns[p].type;
+    }
+    return -1;
+}
+
+/* Build the DFA once from the regex patterns in token_info[]. */
+static void lexer_dfa_init(void) {
+    if (dfa.initialized) return;
+
+    dfa.n_patterns = 0;
+    dfa.n_positions = 0;
     for (int i = 0; i < NUM_TOKENS; i++) {
-        if (token_info[i].pattern && token_info[i].type != TOK_COMMENT && token_info[i].type != TOK_EOF && token_info[i].type != TOK_UNKNOWN) {
-            if (regcomp(&token_info[i].re, token_info[i].pattern, REG_EXTENDED) != 0) {
-                fprintf(stderr, "Failed to compile regex for token %s\n", token_type_to_string(token_info[i].type));
+        if (!token_info[i].pattern || token_info[i].pattern[0] == '\0') continue;
+
+        DfaPattern *pat = &dfa.patterns[dfa.n_patterns];
+        pat->type = token_info[i].type;
+        if (dfa_parse_pattern(token_info[i].pattern, pat) != 0) {
+            fprintf(stderr, "lexer: unsupported pattern for token %s\n",
+                    token_type_to_string(token_info[i].type));
+            exit(EXIT_FAILURE);
+        }
+
+        /* flatten positions 0..n_items (inclusive: n_items = accept) */
+        dfa.pat_base[dfa.n_patterns] = dfa.n_positions;
+        for (size_t j = 0; j <= pat->n_items; j++) {
+            if (dfa.n_positions >= DFA_MAX_NFA) {
+                fprintf(stderr, "lexer: DFA position limit exceeded\n");
                 exit(EXIT_FAILURE);
             }
+            dfa.pat_of[dfa.n_positions] = dfa.n_patterns;
+            dfa.item_of[dfa.n_positions] = j;
+            dfa.n_positions++;
+        }
+        dfa.n_patterns++;
+    }
+
+    /* subset construction; state 0 is the dead state */
+    NfaSet state_sets[DFA_MAX_STATES];
+    state_sets[0] = 0;
+    dfa.accept[0] = -1;
+    memset(dfa.trans[0], 0, sizeof(dfa.trans[0]));
+
+    NfaSet start = 0;
+    for (size_t p = 0; p < dfa.n_patterns; p++)
+        start |= 1u << dfa.pat_base[p];
+    start = dfa_closure(start);
+
+    state_sets[1] = start;
+    dfa.accept[1] = dfa_set_accept(start);
+    dfa.n_states = 2;
+
+    for (size_t s = 1; s < dfa.n_states; s++) {
+        for (int c = 0; c < 256; c++) {
+            NfaSet next = 0;
+            for (size_t pos = 0; pos < dfa.n_positions; pos++) {
+                if (!(state_sets[s] & (1u << pos))) continue;
+                size_t p = dfa.pat_of[pos];
+                size_t i = dfa.item_of[pos];
+                if (i >= dfa.patterns[p].n_items) continue; /* accept pos */
+                DfaItem *item = &dfa.patterns[p].items[i];
+                if (!item->in_class[c]) continue;
+                /* consume one char: may repeat or advance */
+                if (item->quant == QUANT_PLUS || item->quant == QUANT_STAR)
+                    next |= 1u << pos;
+                next |= 1u << (dfa.pat_base[p] + i + 1);
+            }
+            next = dfa_closure(next);
+
+            if (next == 0) {
+                dfa.trans[s][c] = 0;
+                continue;
+            }
+
+            /* find or add the DFA state for this subset */
+            size_t t;
+            for (t = 1; t < dfa.n_states; t++) {
+                if (state_sets[t] == next) break;
+            }
+            if (t == dfa.n_states) {
+                if (dfa.n_states >= DFA_MAX_STATES) {
+                    fprintf(stderr, "lexer: DFA state limit exceeded\n");
+                    exit(EXIT_FAILURE);
+                }
+                state_sets[t] = next;
+                dfa.accept[t] = dfa_set_accept(next);
+                dfa.n_states++;
+            }
+            dfa.trans[s][c] = (unsigned char)t;
+        }
+    }
+
+    dfa.initialized = 1;
+}
+
+/* ---------------------------------------------------------------
+ * First-byte dispatch table for fixed-spelling tokens.
+ *
+ * The fixed-spelling entries of token_info[] (keywords and
+ * punctuation) are bucketed once at startup by their first byte,
+ * each bucket sorted by descending length. Matching a token then
+ * touches only the handful of literals that can possibly start at
+ * the cursor, and the first hit in a bucket is already the longest
+ * one. Keyword-like literals (starting with a letter/underscore)
+ * carry a flag so only they pay the identifier-boundary check.
+ * --------------------------------------------------------------- */
+
+typedef struct {
+    TokenType type;
+    const char *text;
+    size_t len;
+    int is_word; /* starts like an identifier: needs boundary check */
+} LiteralCandidate;
+
+static struct {
+    int initialized;
+    LiteralCandidate pool[NUM_TOKENS]; /* grouped by first byte */
+    size_t n;
+    unsigned char start[256]; /* index of first candidate per byte */
+    unsigned char count[256]; /* number of candidates per byte */
+} literals;
+
+static void lexer_literals_init(void) {
+    if (literals.initialized) return;
+
+    literals.n = 0;
+    memset(literals.count, 0, sizeof(literals.count));
+
+    /* collect all fixed-spelling tokens */
+    for (int i = 0; i < NUM_TOKENS; i++) {
+        if (!token_info[i].printable || token_info[i].pattern != NULL) continue;
+        LiteralCandidate *c = &literals.pool[literals.n++];
+        c->type = token_info[i].type;
+        c->text = token_info[i].printable;
+        c->len = strlen(c->text);
+        unsigned char first = (unsigned char)c->text[0];
+        c->is_word = isalpha(first) || first == '_';
+    }
+
+    /* sort by (first byte, length descending) — insertion sort is
+       plenty for this table size */
+    for (size_t i = 1; i < literals.n; i++) {
+        LiteralCandidate key = literals.pool[i];
+        size_t j = i;
+        while (j > 0 &&
+               ((unsigned char)literals.pool[j-1].text[0] > (unsigned char)key.text[0] ||
+                ((unsigned char)literals.pool[j-1].text[0] == (unsigned char)key.text[0] &&
+                 literals.pool[j-1].len < key.len))) {
+            literals.pool[j] = literals.pool[j-1];
+            j--;
         }
+        literals.pool[j] = key;
+    }
+
+    /* record each byte's bucket */
+    for (size_t i = 0; i < literals.n; i++) {
+        unsigned char first = (unsigned char)literals.pool[i].text[0];
+        if (literals.count[first] == 0) literals.start[first] = (unsigned char)i;
+        literals.count[first]++;
     }
+
+    literals.initialized = 1;
 }
 
+/* Build the DFA and first-byte dispatch tables. Idempotent; the
+ * parallel driver calls this once before spawning workers so the
+ * lazily-built tables are never raced on. */
+void lexer_init_tables(void) {
+    lexer_dfa_init();
+    lexer_literals_init();
+}
 
 Lexer *lexer_create(const char *src) {
     Lexer *lx = malloc(sizeof(Lexer));
@@ -20,10 +303,9 @@ Lexer *lexer_create(const char *src) {
         exit(EXIT_FAILURE);
     }
     lx->src = src;
+    lx->end = src + strlen(src);
     lx->cursor = src;
-    lx->line = 1;
-    lx->column = 1;
-    compile_regex_patterns(); // Precompile regex patterns for tokens
+    lexer_init_tables();   /* once per process; no-op afterwards */
     return lx;
 }
 
@@ -33,115 +315,193 @@ void free_lexer(Lexer *lx) {
     }
 }
 
-Token* lexer_handle_comment(Lexer *lx) {
+/* ---------------------------------------------------------------
+ * Bulk scanning kernels
+ *
+ * lexer_next() spends most of its time walking runs of uniform
+ * bytes: whitespace between tokens, `//` comment bodies, and
+ * identifier characters. On SSE2 targets those runs are scanned 16
+ * bytes at a time; elsewhere the scalar loops below do the same
+ * job. Vector loads stop short of lx->end, so the trailing
+ * (< 16 byte) stretch of the buffer always takes the scalar path
+ * and nothing is ever read past the terminator.
+ * --------------------------------------------------------------- */
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+/* Per-byte unsigned range test: 0xFF where lo <= v <= hi. */
+static inline __m128i lexer_bytes_in_range(__m128i v, unsigned char lo,
+                                           unsigned char hi) {
+    __m128i ge = _mm_cmpeq_epi8(_mm_subs_epu8(_mm_set1_epi8((char)lo), v),
+                                _mm_setzero_si128());
+    __m128i le = _mm_cmpeq_epi8(_mm_subs_epu8(v, _mm_set1_epi8((char)hi)),
+                                _mm_setzero_si128());
+    return _mm_and_si128(ge, le);
+}
+#endif
+
+/* Skip [ \t\n\v\f\r]* from the cursor. */
+static void lexer_skip_whitespace(Lexer *lx) {
+#ifdef __SSE2__
+    while (lx->end - lx->cursor >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)lx->cursor);
+        __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                  lexer_bytes_in_range(v, '\t', '\r'));
+        int mask = _mm_movemask_epi8(ws);
+        if (mask != 0xFFFF) {
+            lx->cursor += __builtin_ctz(~mask);
+            return;
+        }
+        lx->cursor += 16;
+    }
+#endif
+    while (isspace(*lx->cursor)) (lx->cursor)++;
+}
+
+/* Length of the run at s up to (not including) '\n' or the end of
+ * the buffer. Used for `//` comment bodies, which never span lines. */
+static size_t lexer_scan_to_newline(const Lexer *lx, const char *s) {
+    const char *p = s;
+#ifdef __SSE2__
+    while (lx->end - p >= 16) { /* no NUL inside a full block */
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        int stop = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+        if (stop) return (size_t)(p - s) + (size_t)__builtin_ctz((unsigned)stop);
+        p += 16;
+    }
+#endif
+    while (*p && *p != '\n') p++;
+    return (size_t)(p - s);
+}
+
+/* Length of the [a-zA-Z0-9_]* run at s. The caller has already
+ * checked that s starts like an identifier. */
+static size_t lexer_scan_ident(const Lexer *lx, const char *s) {
+    const char *p = s;
+#ifdef __SSE2__
+    while (lx->end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i id = _mm_or_si128(
+            _mm_or_si128(lexer_bytes_in_range(v, 'a', 'z'),
+                         lexer_bytes_in_range(v, 'A', 'Z')),
+            _mm_or_si128(lexer_bytes_in_range(v, '0', '9'),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8('_'))));
+        int mask = _mm_movemask_epi8(id);
+        if (mask != 0xFFFF)
+            return (size_t)(p - s) + (size_t)__builtin_ctz(~(unsigned)mask);
+        p += 16;
+    }
+#endif
+    while (isalnum((unsigned char)*p) || *p == '_') p++;
+    return (size_t)(p - s);
+}
+
+/* Helpers fill *out and return 1 on a match, 0 otherwise. */
+static int lexer_handle_comment(Lexer *lx, Token *out) {
     if (*lx->cursor == '/' && *(lx->cursor + 1) == '/') {
         const char *start = lx->cursor;
-        while (*lx->cursor && *lx->cursor != '\n') {
-            (lx->cursor)++;
-            (lx->column)++;
-        }
+        lx->cursor += lexer_scan_to_newline(lx, lx->cursor);
         start += 2; // skip "//"
-        return create_token(TOK_COMMENT, start, lx->cursor - start, lx->line, lx->column);
+        *out = token_make(TOK_COMMENT, start, lx->cursor - start);
+        return 1;
     }
-    return NULL; // Not a comment
+    return 0; // Not a comment
 }
 
-Token* lexer_handle_literal_comparisons(Lexer *lx) {
-    int best_idx = -1;
-    size_t best_len = 0;
+static int lexer_handle_literal_comparisons(Lexer *lx, Token *out) {
+    unsigned char first = (unsigned char)*lx->cursor;
+    size_t begin = literals.start[first];
+    size_t end = begin + literals.count[first];
 
-    for (int i = 0; i < NUM_TOKENS; i++) {
-        if (token_info[i].printable && token_info[i].pattern == NULL) {
-            const char *lit = token_info[i].printable;
-            size_t len = strlen(lit);
-
-            
-            if (strncmp(lx->cursor, lit, len) != 0) continue;
-
-            /* Only enforce identifier-boundary if the literal starts like an identifier
-               (letter or underscore). For punctuation tokens (e.g. '[') do not enforce. */
-            unsigned char first = (unsigned char)lit[0];
-            if ((isalpha(first) || first == '_')) {
-                unsigned char next = (unsigned char)lx->cursor[len];
-                if (next && (isalnum(next) || next == '_')) {
-                    /* It's a prefix of a longer identifier, skip this literal match */
-                    continue;
-                }
-            }
+    /* candidates in a bucket are sorted longest-first, so the first
+       match that survives the boundary check is the longest match */
+    for (size_t i = begin; i < end; i++) {
+        LiteralCandidate *c = &literals.pool[i];
+
+        if (strncmp(lx->cursor, c->text, c->len) != 0) continue;
 
-            /* prefer the longest printable token (handles overlapping literals) */
-            if (len > best_len) {
-                best_len = len;
-                best_idx = i;
+        /* Only enforce identifier-boundary if the literal starts like an identifier
+           (letter or underscore). For punctuation tokens (e.g. '[') do not enforce. */
+        if (c->is_word) {
+            unsigned char next = (unsigned char)lx->cursor[c->len];
+            if (next && (isalnum(next) || next == '_')) {
+                /* It's a prefix of a longer identifier, skip this literal match */
+                continue;
             }
         }
-    }
 
-    if (best_idx != -1) {
-        Token* t = create_token(token_info[best_idx].type,
-                                lx->cursor, best_len,
-                                lx->line, lx->column);
-        lx->cursor += best_len;
-        lx->column += best_len;
-        return t;
+        *out = token_make(c->type, lx->cursor, c->len);
+        lx->cursor += c->len;
+        return 1;
     }
 
-    return NULL; // No match found
+    return 0; // No match found
 }
 
-Token* lexer_handle_regex(Lexer *lx) {
-    for (int i = 0; i < NUM_TOKENS; i++) {
-        if (token_info[i].pattern != NULL) {
-            regex_t *re = &token_info[i].re;
-
-            regmatch_t match;
-            if (regexec(re, lx->cursor, 1, &match, 0) == 0) {
-                size_t len = match.rm_eo - match.rm_so;
-                Token* t = create_token(token_info[i].type,
-                                        lx->cursor + match.rm_so, len,
-                                        lx->line, lx->column);
-                lx->cursor += match.rm_eo;
-                lx->column += len;
-                return t;
-            }
+/* Classify identifiers / integer / float literals in a single pass
+ * over the input using the DFA built by lexer_dfa_init(). Maximal
+ * munch: we remember the last accepting state seen and emit the
+ * token ending there. */
+static int lexer_handle_dfa(Lexer *lx, Token *out) {
+    const char *s = lx->cursor;
+    size_t state = 1; /* start state */
+    int best_type = -1;
+    size_t best_len = 0;
+    size_t len = 0;
+
+    while (s[len]) {
+        state = dfa.trans[state][(unsigned char)s[len]];
+        if (state == 0) break; /* dead state: no further match possible */
+        len++;
+        if (dfa.accept[state] != -1) {
+            best_type = dfa.accept[state];
+            best_len = len;
         }
     }
-    return NULL; // No regex match found
+
+    if (best_type == -1) return 0;
+
+    *out = token_make((TokenType)best_type, lx->cursor, best_len);
+    lx->cursor += best_len;
+    return 1;
 }
 
 
 
-Token* lexer_next(Lexer *lx) {
+void lexer_next(Lexer *lx, Token *out) {
+    STATS_INC(tokens);
+
     // 1. Skip whitespace
-    while (isspace(*lx->cursor)) {
-        if (*lx->cursor == '\n') { (lx->line)++; lx->column = 1; }
-        else (lx->column)++;
-        (lx->cursor)++;
-    }
+    lexer_skip_whitespace(lx);
 
     // 2. Check for end of input
     if (!*lx->cursor) {
-        return create_token(TOK_EOF, "", 0, lx->line, lx->column);
+        /* point at the terminator so EOF still resolves to a position */
+        *out = token_make(TOK_EOF, lx->cursor, 0);
+        return;
     }
 
     // 3. Check for comments
-    Token *comment = lexer_handle_comment(lx);
-    if (comment) {
-        return comment;
-    }
+    if (lexer_handle_comment(lx, out)) return;
 
     // 4. Try fixed spelling tokens (literal comparisons)
-    Token *fixed_token = lexer_handle_literal_comparisons(lx);
-    if (fixed_token) {
-        return fixed_token;
-    }
+    if (lexer_handle_literal_comparisons(lx, out)) return;
 
-    // 5. Try regex-based tokens
-    Token *regex_token = lexer_handle_regex(lx);
-    if (regex_token) {
-        return regex_token;
+    // 5. Identifiers are by far the most common pattern token; scan the
+    //    run directly instead of stepping the DFA byte by byte. Keywords
+    //    were already claimed by the literal table above.
+    unsigned char c0 = (unsigned char)*lx->cursor;
+    if (isalpha(c0) || c0 == '_') {
+        size_t len = lexer_scan_ident(lx, lx->cursor);
+        *out = token_make(TOK_IDENTIFIER, lx->cursor, len);
+        lx->cursor += len;
+        return;
     }
 
-    // 6. If no match, consume one character as an unknown token
-    return create_token(TOK_UNKNOWN, lx->cursor++, 1, lx->line, lx->column++);
-}
\ No newline at end of file
+    // 6. Try pattern-based tokens (numeric literals) via the DFA
+    if (lexer_handle_dfa(lx, out)) return;
+
+    // 7. If no match, consume one character as an unknown token
+    *out = token_make(TOK_UNKNOWN, lx->cursor++, 1);
+}
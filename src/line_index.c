@@ -0,0 +1,63 @@
+#include "line_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void line_index_init(LineIndex *li, const char *src) {
+    li->src = src;
+    li->offsets = NULL;
+    li->count = 0;
+}
+
+void line_index_build(LineIndex *li) {
+    if (!li || !li->src || li->offsets) return;
+
+    size_t cap = 256, n = 0;
+    size_t *offsets = malloc(cap * sizeof *offsets);
+    if (!offsets) return;
+
+    offsets[n++] = 0;
+    for (const char *s = li->src; (s = strchr(s, '\n')) != NULL; ) {
+        ++s;
+        if (n == cap) {
+            cap *= 2;
+            size_t *grown = realloc(offsets, cap * sizeof *offsets);
+            if (!grown) { free(offsets); return; }
+            offsets = grown;
+        }
+        offsets[n++] = (size_t)(s - li->src);
+    }
+
+    li->offsets = offsets;
+    li->count = n;
+}
+
+void line_index_locate(LineIndex *li, const char *pos,
+                       size_t *line, size_t *col) {
+    *line = 0;
+    *col = 0;
+    if (!li || !li->src || !pos || pos < li->src) return;
+
+    line_index_build(li);
+    if (!li->offsets) return;
+
+    size_t off = (size_t)(pos - li->src);
+
+    /* greatest i with offsets[i] <= off */
+    size_t lo = 0, hi = li->count;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (li->offsets[mid] <= off) lo = mid;
+        else hi = mid;
+    }
+
+    *line = lo + 1;
+    *col = off - li->offsets[lo] + 1;
+}
+
+void line_index_free(LineIndex *li) {
+    if (!li) return;
+    free(li->offsets);
+    li->offsets = NULL;
+    li->count = 0;
+}
@@ -4,18 +4,32 @@
 #include <stdlib.h>
 #include <string.h>
 #include "driver.h"
+#include "bench.h"
 
 /* tests_run_all provided by tests.c */
 extern void tests_run_all(void);
 
 static void print_usage(const char *progname) {
     fprintf(stderr,
-        "Usage: %s [options] <source-file>\n"
+        "Usage: %s [options] <source-file>...\n"
         "Options:\n"
         "  --tokens        Dump tokens after lexing\n"
         "  --ast           Dump AST after parsing\n"
         "  --time          Print timing for each phase (ms)\n"
+        "  --stream        Fuse lexing and parsing (pull-based token stream)\n"
+        "  --daemon        Stay resident; serve compile requests from stdin\n"
+        "  -j <n>          Compile multiple files with n worker threads\n"
+        "                  (default: one per CPU)\n"
         "  --test          Run the built-in test suite\n"
+        "  --bench         Run the front-end benchmark suite\n"
+        "  --bench-json <f>      Write machine-readable bench results to <f>\n"
+        "  --bench-min-mbps <x>  Fail if median parse throughput drops below x\n"
+        "  --stats         Print hot-path counters (tokens, nodes, probes)\n"
+        "  --mem-stats     Print per-phase allocation totals and peak RSS\n"
+        "  --cache <dir>   Reuse results for unchanged sources via <dir>\n"
+        "  --emit-ast-bin <f>    Write the AST to <f> in binary form\n"
+        "  --tokens-bin <f>      Write the token stream to <f> in binary form\n"
+        "  --sem           Analyze function bodies (parallel with -j)\n"
         "  --sym-table     Print symbol table\n"
         "  --type-tree     Print hierarchical type structures\n"
         "  --help, -h      Show this message\n",
@@ -27,7 +41,15 @@ int main(int argc, char **argv) {
 
     /* quick flag parsing - handle options in any order */
     bool run_tests = false;
+    bool run_bench = false;
+    bool run_daemon = false;
+    const char *bench_json = NULL;
+    double bench_min_mbps = 0.0;
     CompilerOptions opts = {0};
+    /* positional args become the file list; argc bounds its size */
+    const char **files = malloc((size_t)argc * sizeof(*files));
+    if (!files) { perror("malloc"); return EXIT_FAILURE; }
+    size_t num_files = 0;
     opts.dump_tokens = false;
     opts.dump_ast = false;
     opts.show_time = false;
@@ -42,37 +64,85 @@ int main(int argc, char **argv) {
             opts.dump_ast = true;
         } else if (strcmp(argv[i], "--time") == 0) {
             opts.show_time = true;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            opts.stream = true;
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            const char *n = argv[i][2] ? argv[i] + 2
+                          : (i + 1 < argc ? argv[++i] : NULL);
+            if (!n || atoi(n) < 0) {
+                fprintf(stderr, "Option -j requires a non-negative count\n");
+                free(files);
+                return EXIT_FAILURE;
+            }
+            opts.jobs = (size_t)atoi(n);
+        } else if (strcmp(argv[i], "--daemon") == 0) {
+            run_daemon = true;
         } else if (strcmp(argv[i], "--test") == 0) {
             run_tests = true;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            run_bench = true;
+        } else if (strcmp(argv[i], "--bench-json") == 0 && i + 1 < argc) {
+            bench_json = argv[++i];
+        } else if (strcmp(argv[i], "--bench-min-mbps") == 0 && i + 1 < argc) {
+            bench_min_mbps = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            opts.show_stats = true;
+        } else if (strcmp(argv[i], "--mem-stats") == 0) {
+            opts.show_mem_stats = true;
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            opts.cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--emit-ast-bin") == 0 && i + 1 < argc) {
+            opts.emit_ast_bin = argv[++i];
+        } else if (strcmp(argv[i], "--tokens-bin") == 0 && i + 1 < argc) {
+            opts.tokens_bin = argv[++i];
+        } else if (strcmp(argv[i], "--sem") == 0) {
+            opts.analyze_bodies = true;
         } else if (strcmp(argv[i], "--sym-table") == 0) {
             opts.show_symbol_table = true;
         } else if (strcmp(argv[i], "--type-tree") == 0) {
             opts.show_hierarchical_types = true;
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
-            print_usage(argv[0]); 
+            print_usage(argv[0]);
+            free(files);
             return EXIT_SUCCESS;
         } else if (argv[i][0] == '-') {
-            fprintf(stderr, "Unknown option: %s\n", argv[i]); 
-            print_usage(argv[0]); 
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            free(files);
             return EXIT_FAILURE;
         } else {
             /* Non-option argument - treat as filename */
-            if (opts.filename == NULL) {
-                opts.filename = argv[i];
-            } else {
-                fprintf(stderr, "Multiple input files specified: '%s' and '%s'\n", 
-                        opts.filename, argv[i]);
-                print_usage(argv[0]);
-                return EXIT_FAILURE;
-            }
+            files[num_files++] = argv[i];
         }
     }
 
     if (run_tests) {
+        free(files);
         tests_run_all();
         return EXIT_SUCCESS;
     }
 
-    if (!opts.filename) { print_usage(argv[0]); return EXIT_FAILURE; }
-    return run_compiler(&opts);
+    if (run_bench) {
+        free(files);
+        return bench_run_all(bench_json, bench_min_mbps);
+    }
+
+    if (run_daemon) {
+        int rc = run_compiler_daemon(&opts);
+        free(files);
+        return rc;
+    }
+
+    if (num_files == 0) {
+        free(files);
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    opts.filename = files[0];
+    opts.filenames = files;
+    opts.num_files = num_files;
+
+    int rc = run_compiler(&opts);
+    free(files);
+    return rc;
 }
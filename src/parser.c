@@ -3,6 +3,7 @@
 // Drop next to parser.h / token.h etc.
 
 #include "parser.h"
+#include "stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -32,16 +33,61 @@
 #define COL_PIPE    ""
 #endif
 
+/* -------------------------
+ * Token access (batch or streaming)
+ * ------------------------- */
+
+/* Ring capacity for streaming mode. peek() only looks a token or two
+ * ahead and parser_rewind() steps back a bounded distance, so a small
+ * power of two is plenty. */
+#define PARSER_RING_CAP 64
+
+/* Streaming: pull one more token from the lexer into the ring,
+ * dropping the oldest buffered token when the ring is full.
+ * Returns 0 once the stream is exhausted. */
+static int parser_pull(Parser *p) {
+    if (p->saw_eof) return 0;
+    Token tok;
+    do { lexer_next(p->lx, &tok); } while (tok.type == TOK_COMMENT);
+
+    size_t abs = p->ring_base + p->tokens.size;
+    if (p->tokens.size == PARSER_RING_CAP) {
+        p->ring_base++; /* lookbehind is bounded: retire the oldest slot */
+        p->tokens.size--;
+    }
+    p->tokens.data[abs % PARSER_RING_CAP] = tok;
+    p->tokens.size++;
+    if (tok.type == TOK_EOF) {
+        p->saw_eof = 1;
+        p->end = abs + 1;
+    }
+    return 1;
+}
+
+/* Absolute token index -> token, pulling from the lexer as needed in
+ * streaming mode. NULL when out of range (or evicted from the ring). */
+static Token *parser_token_at(Parser *p, size_t idx) {
+    if (!p) return NULL;
+    if (!p->lx) return (idx < p->tokens.size) ? &p->tokens.data[idx] : NULL;
+    if (idx < p->ring_base) return NULL;
+    while (idx >= p->ring_base + p->tokens.size) {
+        if (!parser_pull(p)) return NULL;
+    }
+    return &p->tokens.data[idx % PARSER_RING_CAP];
+}
+
 /* -------------------------
  * Public: create_parse_error
  * ------------------------- */
 void create_parse_error(ParseError *err_out, const char *message, Parser *p) {
     if (!err_out) return;
-    err_out->message = message ? strdup(message) : NULL;
-    err_out->token = (p && p->current < p->tokens.size) ? p->tokens.data[p->current] : NULL;
-    err_out->line = err_out->token ? err_out->token->line : 0;
-    err_out->col  = err_out->token ? err_out->token->col  : 0;
-    err_out->filename = p && p->filename ? strdup(p->filename) : NULL;
+    /* record only: messages are static strings, and the position and
+       filename are resolved when the diagnostic is rendered */
+    err_out->message = message;
+    err_out->token = current_token(p);
+    err_out->line = 0;
+    err_out->col = 0;
+    err_out->filename = NULL;
     err_out->p = p;
 }
 
@@ -59,10 +105,11 @@ static void print_token_info(ParseError *error) {
     size_t col  = error ? error->col  : 0;
     if (error && error->token) {
         const char *tokname = token_type_to_string(error->token->type);
-        const char *lexeme = error->token->lexeme ? error->token->lexeme : "";
-        if (lexeme[0])
-            fprintf(stderr, COL_LABEL "Found:" COL_RESET " " COL_TOKEN "%s" COL_RESET " " COL_LEXEME "\"%s\"" COL_RESET " at " COL_FILENAME "%s" COL_RESET ":" COL_LINENO "%zu:%zu" COL_RESET "\n", 
-                    tokname, lexeme, filename, line, col);
+        const char *lexeme = error->token->start ? error->token->start : "";
+        int lexeme_len = (int)error->token->len;
+        if (lexeme_len > 0)
+            fprintf(stderr, COL_LABEL "Found:" COL_RESET " " COL_TOKEN "%s" COL_RESET " " COL_LEXEME "\"%.*s\"" COL_RESET " at " COL_FILENAME "%s" COL_RESET ":" COL_LINENO "%zu:%zu" COL_RESET "\n",
+                    tokname, lexeme_len, lexeme, filename, line, col);
         else
             fprintf(stderr, COL_LABEL "Found:" COL_RESET " " COL_TOKEN "%s" COL_RESET " at " COL_FILENAME "%s" COL_RESET ":" COL_LINENO "%zu:%zu" COL_RESET "\n", 
                     tokname, filename, line, col);
@@ -72,12 +119,34 @@ static void print_token_info(ParseError *error) {
 }
 
 /* -------------------------
- * Read a single (1-based) line from a file and return strdup'd string (no newline)
- * Caller must free. Returns NULL on EOF/error.
+ * Line access for snippets
+ *
+ * The parser holds the whole source in memory, so instead of re-opening
+ * and rescanning the file per requested line, a line-start offset index
+ * is built once (lazily, on the first snippet) and any line is then an
+ * O(1) slice of the buffer.
  * ------------------------- */
-static char *read_file_line(FILE *f, size_t target_line) {
-    if (!f || target_line == 0) return NULL;
-    rewind(f);
+/* strdup'd copy of the (1-based) line without trailing newline, sliced
+ * from the source buffer via the index. Caller frees. */
+static char *parser_line_dup(Parser *p, size_t target_line) {
+    if (!p || !p->source) return NULL;
+    line_index_build(&p->li);
+    if (!p->li.offsets || target_line == 0 || target_line > p->li.count)
+        return NULL;
+
+    const char *start = p->source + p->li.offsets[target_line - 1];
+    size_t len = strcspn(start, "\n");
+    while (len > 0 && start[len - 1] == '\r') len--;
+    return strndup(start, len);
+}
+
+/* Fallback for errors with no parser/source attached: read a single
+ * (1-based) line from the file. Caller frees. */
+static char *read_file_line(const char *filename, size_t target_line) {
+    if (!filename || target_line == 0) return NULL;
+    FILE *f = fopen(filename, "r");
+    if (!f) return NULL;
+
     char *buf = NULL;
     size_t buflen = 0;
     ssize_t n;
@@ -92,14 +161,24 @@ static char *read_file_line(FILE *f, size_t target_line) {
             }
             char *ret = strdup(buf ? buf : "");
             free(buf);
+            fclose(f);
             return ret;
         }
     }
 
     free(buf);
+    fclose(f);
     return NULL;
 }
 
+/* Preferred line access for error rendering: O(1) slice when the
+ * parser's source buffer is available, file rescan otherwise. */
+static char *error_line_dup(ParseError *error, size_t target_line) {
+    if (error->p && error->p->source)
+        return parser_line_dup(error->p, target_line);
+    return read_file_line(error->filename, target_line);
+}
+
 /* -------------------------
  * Print a single source line with gutter "  <line_no> | <code>"
  * line_no_width must be enough digits to align numbers.
@@ -170,26 +249,22 @@ static void print_source_snippet(ParseError *error) {
     if (error->underline_previous_token_line && error->p) {
         Parser *p = error->p;
         if (p->current > 0 && p->tokens.data) {
-            size_t prev_index = p->current - 1;
-            if (prev_index < p->tokens.size) prev_token = p->tokens.data[prev_index];
+            prev_token = parser_token_at(p, p->current - 1);
         }
         
-        if (prev_token && prev_token->line > 0) {
-            prev_line = prev_token->line;
-            prev_col  = prev_token->col ? prev_token->col : 1;
-            if (primary_line == 0 || prev_line < primary_line) use_prev_line = 1;
+        if (prev_token) {
+            line_index_locate(&p->li, prev_token->start, &prev_line, &prev_col);
+            if (prev_col == 0) prev_col = 1;
+            if (prev_line > 0 &&
+                (primary_line == 0 || prev_line < primary_line)) use_prev_line = 1;
         }
     }
 
 
-    /* open file */
-    FILE *f = fopen(error->filename, "r");
-    if (!f) return;
-
     /* compute gutter width based on max line number we'll print */
     size_t max_line = primary_line;
     if (use_prev_line && prev_line > max_line) max_line = prev_line;
-    if (max_line == 0) { fclose(f); return; }
+    if (max_line == 0) return;
     int line_no_width = 1;
     size_t tmp = max_line;
     while (tmp >= 10) { tmp /= 10; ++line_no_width; }
@@ -198,7 +273,7 @@ static void print_source_snippet(ParseError *error) {
 
     if (use_prev_line) {
         /* print previous line once */
-        char *prev_buf = read_file_line(f, prev_line);
+        char *prev_buf = error_line_dup(error, prev_line);
         if (!prev_buf) {
             /* fallback to single-line primary printing */
             use_prev_line = 0;
@@ -207,9 +282,8 @@ static void print_source_snippet(ParseError *error) {
                otherwise use prev_col (start column). prev_col is 1-based.
              */
             size_t caret_col = 1;
-            if (prev_token && prev_token->lexeme && prev_token->lexeme[0] != '\0') {
-                size_t lex_len = strlen(prev_token->lexeme);
-                caret_col = prev_col + lex_len; /* caret after last char of token */
+            if (prev_token && prev_token->start && prev_token->len > 0) {
+                caret_col = prev_col + prev_token->len; /* caret after last char of token */
             } else {
                 caret_col = prev_col ? prev_col : 1;
             }
@@ -226,22 +300,21 @@ static void print_source_snippet(ParseError *error) {
 
             /* print primary line for context if different */
             if (primary_line > 0 && primary_line != prev_line) {
-                char *prim = read_file_line(f, primary_line);
+                char *prim = error_line_dup(error, primary_line);
                 if (prim) {
                     print_line_with_gutter(primary_line, prim, line_no_width);
                     free(prim);
                 }
             }
 
-            fclose(f);
             return;
         }
     }
 
     /* single-line (normal) mode: primary line + caret at primary_col */
-    if (primary_line == 0) { fclose(f); return; }
-    char *prim = read_file_line(f, primary_line);
-    if (!prim) { fclose(f); return; }
+    if (primary_line == 0) return;
+    char *prim = error_line_dup(error, primary_line);
+    if (!prim) return;
 
     /* clamp caret to line */
     size_t line_len = strlen(prim);
@@ -252,7 +325,6 @@ static void print_source_snippet(ParseError *error) {
     print_caret_line_for(prim, caret, line_no_width);
 
     free(prim);
-    fclose(f);
 }
 
 /* -------------------------
@@ -260,6 +332,14 @@ static void print_source_snippet(ParseError *error) {
  * ------------------------- */
 void print_parse_error(ParseError *error) {
     if (!error) return;
+    /* deferred resolution: this is the rare path, and the first (often
+       only) time the parser's line index gets built */
+    if (error->p) {
+        if (!error->filename) error->filename = error->p->filename;
+        if (error->token && error->line == 0)
+            line_index_locate(&error->p->li, error->token->start,
+                              &error->line, &error->col);
+    }
     print_header(error);
     print_token_info(error);
     print_source_snippet(error);
@@ -271,14 +351,14 @@ void print_parse_error(ParseError *error) {
  * Small parser/token helpers (thin wrappers)
  * ------------------------- */
 Token *current_token(Parser *p) {
-    if (!p) return NULL;
-    return (p->current >= p->end) ? NULL : p->tokens.data[p->current];
+    if (!p || p->current >= p->end) return NULL;
+    return parser_token_at(p, p->current);
 }
 
 Token *peek(Parser *p, size_t offset) {
     if (!p) return NULL;
     size_t idx = p->current + offset;
-    return (idx < p->end) ? p->tokens.data[idx] : NULL;
+    return (idx < p->end) ? parser_token_at(p, idx) : NULL;
 }
 
 Token *consume(Parser *p, TokenType expected) {
@@ -291,7 +371,7 @@ Token *consume(Parser *p, TokenType expected) {
 /* -------------------------
  * Parser lifecycle
  * ------------------------- */
-Parser *parser_create(TokenArray tokens, const char *filename) {
+Parser *parser_create(TokenArray tokens, const char *filename, const char *source) {
     Parser *p = malloc(sizeof(Parser));
     if (!p) {
         fprintf(stderr, "memory allocation failed\n");
@@ -301,16 +381,60 @@ Parser *parser_create(TokenArray tokens, const char *filename) {
     p->current = 0;
     p->end = tokens.size;
     p->filename = filename ? strdup(filename) : NULL;
+    p->lx = NULL;
+    p->ring_base = 0;
+    p->saw_eof = 1;
+    p->source = source;
+    line_index_init(&p->li, source);
+    return p;
+}
+
+/* Pull-based parser: tokens flow from the lexer through a small ring
+ * instead of being materialized up front, so parsing starts immediately
+ * and peak memory no longer scales with file size. */
+Parser *parser_create_streaming(Lexer *lx, const char *filename) {
+    Parser *p = malloc(sizeof(Parser));
+    if (!p) {
+        fprintf(stderr, "memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    token_array_init(&p->tokens);
+    p->tokens.data = malloc(sizeof(Token) * PARSER_RING_CAP);
+    if (!p->tokens.data) {
+        fprintf(stderr, "memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    p->tokens.capacity = PARSER_RING_CAP;
+    p->current = 0;
+    p->end = (size_t)-1; /* unknown until the lexer reports EOF */
+    p->filename = filename ? strdup(filename) : NULL;
+    p->lx = lx;
+    p->ring_base = 0;
+    p->saw_eof = 0;
+    p->source = lx ? lx->src : NULL;
+    line_index_init(&p->li, p->source);
     return p;
 }
 
 void parser_free(Parser *parser) {
     if (!parser) return;
+    if (parser->lx) free(parser->tokens.data); /* ring is parser-owned */
+    line_index_free(&parser->li);
     free(parser->filename);
     free(parser);
 }
 
+/* Step back over already-consumed tokens. No production uses this
+ * anymore: since the precedence-climbing rewrite the grammar is fully
+ * predictive (at most two tokens of lookahead, never a re-parse), so
+ * the --stats rewind counter staying at zero is a guarded invariant —
+ * see the backtracking canary in tests.c. The entry point is kept for
+ * future speculative productions; anything that starts rewinding over
+ * long ranges should memoize its outcome keyed on Parser.current
+ * rather than re-parsing. */
 void parser_rewind(Parser *p, size_t steps) {
+    STATS_INC(parser_rewinds);
     if (!p || steps > p->current) return; // cannot rewind beyond start
+    if (p->lx && p->current - steps < p->ring_base) return; // evicted from ring
     p->current -= steps;
 }
@@ -48,32 +48,26 @@ static void print_indent(int indent) {
     for (int i = 0; i < indent; ++i) putchar(' ');
 }
 
-static void hashmap_print_entries(HashMap *map, int indent) {
-    if (!map) {
-        print_indent(indent);
-        printf("hashmap_print_entries empty hashmap");
-        return;
+static void print_symbol_entry(char *key, Symbol *sym, int indent) {
+    print_indent(indent);
+    if (key) printf("%s : ", key);
+    else printf("<anon> : ");
+
+    if (sym && sym->sem_type) {
+        type_print(sym->sem_type);
+    } else {
+        printf("<NULL-symbol>");
     }
+    printf("\n");
+}
 
-    for (size_t b = 0; b < map->bucket_count; ++b) {
-        DynArray *bucket = &map->buckets[b];
-        for (size_t j = 0; j < bucket->count; ++j) {
-            KeyValue *kv = (KeyValue*)dynarray_get(bucket, j);
-            char *key = (char*)kv->key;
-            Symbol *sym = (Symbol*)kv->value;
-
-            print_indent(indent);
-            if (key) printf("%s : ", key);
-            else printf("<anon> : ");
-
-            if (sym && sym->sem_type) {
-                type_print(sym->sem_type);
-            } else {
-                printf("<NULL-symbol>");
-            }
-            printf("\n");
-        }
-    }
+static void symbol_table_print_entries(SymbolTable *table, int indent) {
+    SymbolTableIter it;
+    char *key;
+    Symbol *sym;
+    symbol_table_iter_init(&it, table);
+    while (symbol_table_iter_next(&it, &key, &sym))
+        print_symbol_entry(key, sym, indent);
 }
 
 void scope_print(Scope *scope) {
@@ -89,11 +83,11 @@ void scope_print(Scope *scope) {
 
         print_indent(indent + 2);
         printf("Functions:\n");
-        hashmap_print_entries(s->functions ? s->functions->table : NULL, indent + 4);
+        symbol_table_print_entries(s->functions, indent + 4);
 
         print_indent(indent + 2);
         printf("Variables:\n");
-        hashmap_print_entries(s->variables ? s->variables->table : NULL, indent + 4);
+        symbol_table_print_entries(s->variables, indent + 4);
 
         s = s->parent;
         indent += 2;
@@ -105,23 +99,16 @@ void scope_print(Scope *scope) {
     }
 }
 
-static void scope_print_bucket_hierarchical(DynArray *bucket, int indent) {
-    if (!bucket) return;
-    for (size_t j = 0; j < bucket->count; ++j) {
-        KeyValue *kv = (KeyValue*)dynarray_get(bucket, j);
-        char *key = (char*)kv->key;
-        Symbol *sym = (Symbol*)kv->value;
+static void scope_print_symbol_hierarchical(char *key, Symbol *sym, int indent) {
+    print_indent(indent);
+    if (key) printf("%s:\n", key);
+    else printf("<anon>:\n");
 
-        print_indent(indent);
-        if (key) printf("%s:\n", key);
-        else printf("<anon>:\n");
-
-        if (sym && sym->sem_type) {
-            type_print_hierarchical_with_indent(sym->sem_type, indent + 2);
-        } else {
-            for (int i = 0; i < indent + 2; i++) printf(" ");
-            printf("<NULL-symbol>\n");
-        }
+    if (sym && sym->sem_type) {
+        type_print_hierarchical_with_indent(sym->sem_type, indent + 2);
+    } else {
+        for (int i = 0; i < indent + 2; i++) printf(" ");
+        printf("<NULL-symbol>\n");
     }
 }
 
@@ -133,22 +120,24 @@ void scope_print_hierarchical(Scope *scope) {
 
     printf("globalScope\n");
 
+    SymbolTableIter it;
+    char *key;
+    Symbol *sym;
+
     /* Functions */
     if (scope->functions) {
         printf("  Functions:\n");
-        for (size_t i = 0; i < scope->functions->table->bucket_count; ++i) {
-            DynArray *bucket = &scope->functions->table->buckets[i];
-            scope_print_bucket_hierarchical(bucket, 4);
-        }
+        symbol_table_iter_init(&it, scope->functions);
+        while (symbol_table_iter_next(&it, &key, &sym))
+            scope_print_symbol_hierarchical(key, sym, 4);
     }
 
     /* Variables */
     if (scope->variables) {
         printf("  Variables:\n");
-        for (size_t i = 0; i < scope->variables->table->bucket_count; ++i) {
-            DynArray *bucket = &scope->variables->table->buckets[i];
-            scope_print_bucket_hierarchical(bucket, 4);
-        }
+        symbol_table_iter_init(&it, scope->variables);
+        while (symbol_table_iter_next(&it, &key, &sym))
+            scope_print_symbol_hierarchical(key, sym, 4);
     }
 }
 
@@ -1,7 +1,12 @@
 #include "semantic_analysis.h"
+#include "arena.h"
+#include "intern.h"
 #include "scope.h"
 #include "utils.h"
 
+#include <pthread.h>
+#include <unistd.h>
+
 
 /* scope_fill_function_declarations: register top-level functions */
 int scope_fill_function_declarations(Scope *global_scope, AstProgram *program) {
@@ -93,6 +98,282 @@ int scope_fill_function_declarations(Scope *global_scope, AstProgram *program) {
 }
 
 
+/* -----------------------
+ * Function body analysis
+ *
+ * Phase two of the two-phase scheme: signatures are already in the
+ * global scope (scope_fill_function_declarations), so each function
+ * body is independent and can be analyzed on its own scope chain.
+ * Diagnostics go through the FILE* so parallel workers can buffer
+ * them per declaration and merge in source order.
+ * --------------------- */
+
+static int sema_node(Scope *scope, AstNode *node, FILE *diag);
+
+/* Statements in a block get their own child scope for locals. */
+static int sema_block(Scope *parent, AstBlock *block, FILE *diag) {
+    Scope s = {0};
+    s.parent = parent;
+    if (ensure_scope_maps(&s) != 0) {
+        fprintf(diag, "semantic_analysis: failed to allocate scope tables\n");
+        return -1;
+    }
+
+    int rc = 0;
+    size_t n = block->statements ? astnode_array_count(block->statements) : 0;
+    for (size_t i = 0; i < n && rc == 0; ++i) {
+        AstNode *stmt = astnode_array_get(block->statements, i);
+        if (stmt) rc = sema_node(&s, stmt, diag);
+    }
+    free_scope_maps(&s);
+    return rc;
+}
+
+static int sema_node(Scope *scope, AstNode *node, FILE *diag) {
+    if (!node) return 0;
+
+    switch (node->node_type) {
+        case AST_VARIABLE_DECLARATION: {
+            AstVariableDeclaration *vd = &node->data.variable_declaration;
+            const char *name = vd->name;
+            if (!name) {
+                fprintf(diag, "semantic_analysis: variable with no name\n");
+                return -1;
+            }
+
+            /* duplicate only within this scope; shadowing outer scopes is fine */
+            if (symbol_table_get(scope->variables, name)) {
+                fprintf(diag, "semantic_analysis: duplicate variable '%s'\n", name);
+                return -1;
+            }
+
+            Type *vtype = asttype_to_type(&vd->type->data.ast_type);
+            if (!vtype) {
+                fprintf(diag, "semantic_analysis: failed to create type for variable '%s'\n", name);
+                return -1;
+            }
+            Symbol *sym = xmalloc(sizeof(*sym));
+            sym->name = (char*)name; /* not owning */
+            sym->sem_type = vtype;
+            sym->is_const_expr = 0;
+
+            if (!symbol_table_put(scope->variables, name, sym)) {
+                fprintf(diag, "semantic_analysis: symbol_table_put failed for '%s'\n", name);
+                type_free(vtype);
+                free(sym);
+                return -1;
+            }
+
+            return sema_node(scope, vd->initializer, diag);
+        }
+
+        case AST_BLOCK:
+            return sema_block(scope, &node->data.block, diag);
+
+        case AST_IF_STATEMENT:
+            if (sema_node(scope, node->data.if_statement.condition, diag) != 0) return -1;
+            if (sema_node(scope, node->data.if_statement.then_branch, diag) != 0) return -1;
+            return sema_node(scope, node->data.if_statement.else_branch, diag);
+
+        case AST_WHILE_STATEMENT:
+            if (sema_node(scope, node->data.while_statement.condition, diag) != 0) return -1;
+            return sema_node(scope, node->data.while_statement.body, diag);
+
+        case AST_FOR_STATEMENT:
+            if (sema_node(scope, node->data.for_statement.init, diag) != 0) return -1;
+            if (sema_node(scope, node->data.for_statement.condition, diag) != 0) return -1;
+            if (sema_node(scope, node->data.for_statement.post, diag) != 0) return -1;
+            return sema_node(scope, node->data.for_statement.body, diag);
+
+        case AST_RETURN_STATEMENT:
+            return sema_node(scope, node->data.return_statement.expression, diag);
+
+        case AST_EXPR_STATEMENT:
+            return sema_node(scope, node->data.expr_statement.expression, diag);
+
+        case AST_BREAK_STATEMENT:
+        case AST_CONTINUE_STATEMENT:
+            return 0;
+
+        /* expressions: nothing checked yet (type checking comes later) */
+        case AST_LITERAL:
+        case AST_IDENTIFIER:
+        case AST_BINARY_EXPR:
+        case AST_UNARY_EXPR:
+        case AST_POSTFIX_EXPR:
+        case AST_ASSIGNMENT_EXPR:
+        case AST_CALL_EXPR:
+        case AST_SUBSCRIPT_EXPR:
+        case AST_INITIALIZER_LIST:
+            return 0;
+
+        default:
+            fprintf(diag, "semantic_analysis: unsupported AST node type %d\n", node->node_type);
+            return -1;
+    }
+}
+
+/* Analyze one function: a scope holding the parameters, with the body
+ * block opening its own child scope under it. */
+static int sema_function(Scope *global_scope, AstFunctionDeclaration *fd, FILE *diag) {
+    Scope fn_scope = {0};
+    fn_scope.parent = global_scope;
+    if (ensure_scope_maps(&fn_scope) != 0) {
+        fprintf(diag, "semantic_analysis: failed to allocate scope tables\n");
+        return -1;
+    }
+
+    int rc = 0;
+    size_t n_params = fd->params ? astnode_array_count(fd->params) : 0;
+    for (size_t i = 0; i < n_params && rc == 0; ++i) {
+        AstNode *param = astnode_array_get(fd->params, i);
+        if (!param || param->node_type != AST_PARAM) continue;
+        AstParam *ap = &param->data.param;
+        if (!ap->name) continue;
+
+        if (symbol_table_get(fn_scope.variables, ap->name)) {
+            fprintf(diag, "semantic_analysis: duplicate parameter '%s' in function '%s'\n",
+                    ap->name, fd->name ? fd->name : "<anon>");
+            rc = -1;
+            break;
+        }
+
+        Symbol *sym = xmalloc(sizeof(*sym));
+        sym->name = ap->name; /* not owning */
+        sym->sem_type = ap->type ? asttype_to_type(&ap->type->data.ast_type) : NULL;
+        sym->is_const_expr = 0;
+        if (!symbol_table_put(fn_scope.variables, ap->name, sym)) {
+            free(sym);
+            rc = -1;
+        }
+    }
+
+    if (rc == 0 && fd->body && fd->body->node_type == AST_BLOCK) {
+        rc = sema_block(&fn_scope, &fd->body->data.block, diag);
+    }
+
+    free_scope_maps(&fn_scope);
+    return rc;
+}
+
+/* -----------------------
+ * Parallel driver
+ * --------------------- */
+
+typedef struct {
+    AstProgram *program;
+    Scope *global_scope;
+    size_t next;            /* next unclaimed declaration index */
+    pthread_mutex_t lock;   /* guards next */
+    char **diags;           /* per-declaration diagnostic text (or NULL) */
+    int *rcs;               /* per-declaration result */
+} SemaQueue;
+
+static void *sema_worker(void *arg) {
+    SemaQueue *q = arg;
+    size_t n = astnode_array_count(q->program->decls);
+
+    /* Worker-local allocations (types, interned keys) live in a
+     * worker-local arena torn down when the pool finishes. The global
+     * scope is only read here. */
+    Arena *arena = arena_create(0);
+    arena_set_current(arena);
+
+    for (;;) {
+        pthread_mutex_lock(&q->lock);
+        size_t i = q->next++;
+        pthread_mutex_unlock(&q->lock);
+        if (i >= n) break;
+
+        AstNode *decl = astnode_array_get(q->program->decls, i);
+        if (!decl || decl->node_type != AST_FUNCTION_DECLARATION) continue;
+
+        char *buf = NULL;
+        size_t buf_len = 0;
+        FILE *diag = open_memstream(&buf, &buf_len);
+        if (!diag) {
+            q->rcs[i] = -1;
+            continue;
+        }
+        q->rcs[i] = sema_function(q->global_scope, &decl->data.function_declaration, diag);
+        fclose(diag);
+        q->diags[i] = buf_len ? buf : (free(buf), NULL);
+    }
+
+    intern_reset();
+    type_table_reset();
+    arena_set_current(NULL);
+    arena_destroy(arena);
+    return NULL;
+}
+
+/* Analyze every function body, farming declarations out to a worker
+ * pool (jobs = 0 picks the online CPU count, 1 runs inline). Workers
+ * buffer their diagnostics per declaration, which are then flushed to
+ * stderr in source order so output is deterministic regardless of
+ * scheduling. */
+int semantic_analysis_program(Scope *global_scope, AstProgram *program, size_t jobs) {
+    if (!global_scope || !program) return -1;
+
+    size_t n = astnode_array_count(program->decls);
+    if (n == 0) return 0;
+
+    if (jobs == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = cpus > 0 ? (size_t)cpus : 1;
+    }
+    if (jobs > n) jobs = n;
+
+    if (jobs == 1) {
+        /* serial: analyze in order, straight to stderr */
+        int rc = 0;
+        for (size_t i = 0; i < n && rc == 0; ++i) {
+            AstNode *decl = astnode_array_get(program->decls, i);
+            if (decl && decl->node_type == AST_FUNCTION_DECLARATION)
+                rc = sema_function(global_scope, &decl->data.function_declaration, stderr);
+        }
+        return rc;
+    }
+
+    SemaQueue q = {0};
+    q.program = program;
+    q.global_scope = global_scope;
+    q.diags = xcalloc(n, sizeof(char *));
+    q.rcs = xcalloc(n, sizeof(int));
+    pthread_mutex_init(&q.lock, NULL);
+
+    pthread_t *threads = xmalloc(jobs * sizeof(*threads));
+    size_t started = 0;
+    for (; started < jobs; ++started) {
+        if (pthread_create(&threads[started], NULL, sema_worker, &q) != 0) {
+            perror("pthread_create");
+            break;
+        }
+    }
+    for (size_t i = 0; i < started; ++i) pthread_join(threads[i], NULL);
+    free(threads);
+    pthread_mutex_destroy(&q.lock);
+
+    if (started == 0) {
+        free(q.diags);
+        free(q.rcs);
+        return -1;
+    }
+
+    /* deterministic merge: source order, independent of scheduling */
+    int rc = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (q.diags[i]) {
+            fputs(q.diags[i], stderr);
+            free(q.diags[i]);
+        }
+        if (q.rcs[i] != 0) rc = -1;
+    }
+    free(q.diags);
+    free(q.rcs);
+    return rc;
+}
+
 // expects a prior call to scope_fill_function_declarations
 // function declarations are already in the global scope
 int semantic_analysis_run(Scope *scope, AstNode *node) {
@@ -116,9 +397,7 @@ int semantic_analysis_run(Scope *scope, AstNode *node) {
             break;
         }
         case AST_FUNCTION_DECLARATION: {
-            // later open scope for function body
-            // and analyze the body
-            break;
+            return sema_function(scope, &node->data.function_declaration, stderr);
         }
 
         case AST_VARIABLE_DECLARATION: {
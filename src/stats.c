@@ -0,0 +1,54 @@
+#include "stats.h"
+
+#include <sys/resource.h>
+
+#ifndef COMPILER_NO_STATS
+
+_Thread_local CompilerStats g_stats;
+_Thread_local StatsPhase g_stats_phase = STATS_PHASE_NONE;
+
+void stats_reset(void) {
+    g_stats = (CompilerStats){0};
+    g_stats_phase = STATS_PHASE_NONE;
+}
+
+void stats_set_phase(StatsPhase phase) {
+    g_stats_phase = phase;
+}
+
+static const char *phase_names[STATS_PHASE_COUNT] = {
+    "other", "load", "lex", "parse", "sem"
+};
+
+void stats_report(FILE *out, const char *filename) {
+    fprintf(out, "Stats for %s:\n", filename ? filename : "<unknown>");
+    fprintf(out, "  tokens:             %lu\n", g_stats.tokens);
+    fprintf(out, "  ast nodes:          %lu\n", g_stats.ast_nodes);
+    fprintf(out, "  hashmap probes:     %lu (%lu collisions)\n",
+            g_stats.hashmap_probes, g_stats.hashmap_collisions);
+    fprintf(out, "  parser rewinds:     %lu\n", g_stats.parser_rewinds);
+    fprintf(out, "  alloc bytes:       ");
+    for (int i = 0; i < STATS_PHASE_COUNT; ++i) {
+        if (g_stats.alloc_bytes[i] == 0) continue;
+        fprintf(out, " %s=%lu", phase_names[i], g_stats.alloc_bytes[i]);
+    }
+    fprintf(out, "\n");
+}
+
+void stats_report_mem(FILE *out, const char *filename) {
+    fprintf(out, "Memory for %s:\n", filename ? filename : "<unknown>");
+    for (int i = 0; i < STATS_PHASE_COUNT; ++i) {
+        if (g_stats.xalloc_bytes[i] == 0 && g_stats.alloc_bytes[i] == 0)
+            continue;
+        fprintf(out, "  %-6s heap=%lu bytes in %lu allocs, arena=%lu bytes\n",
+                phase_names[i],
+                g_stats.xalloc_bytes[i], g_stats.xalloc_count[i],
+                g_stats.alloc_bytes[i]);
+    }
+
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+        fprintf(out, "  peak RSS: %ld KB\n", ru.ru_maxrss);
+}
+
+#endif /* !COMPILER_NO_STATS */
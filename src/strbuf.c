@@ -0,0 +1,68 @@
+#include "strbuf.h"
+#include "utils.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void strbuf_init(StrBuf *s) {
+    s->cap = 128;
+    s->buf = xmalloc(s->cap);
+    s->len = 0;
+    s->buf[0] = '\0';
+}
+
+void strbuf_free(StrBuf *s) {
+    if (!s) return;
+    free(s->buf);
+    s->buf = NULL;
+    s->len = 0;
+    s->cap = 0;
+}
+
+static void strbuf_ensure(StrBuf *s, size_t extra) {
+    if (s->len + extra + 1 > s->cap) {
+        while (s->len + extra + 1 > s->cap) s->cap *= 2;
+        s->buf = xrealloc(s->buf, s->cap);
+    }
+}
+
+void strbuf_append(StrBuf *s, const char *str) {
+    if (!str) return;
+    size_t add = strlen(str);
+    strbuf_ensure(s, add);
+    memcpy(s->buf + s->len, str, add);
+    s->len += add;
+    s->buf[s->len] = '\0';
+}
+
+void strbuf_append_char(StrBuf *s, char c) {
+    strbuf_ensure(s, 1);
+    s->buf[s->len++] = c;
+    s->buf[s->len] = '\0';
+}
+
+void strbuf_appendf(StrBuf *s, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    /* compute needed size */
+    va_list ap2;
+    va_copy(ap2, ap);
+    int needed = vsnprintf(NULL, 0, fmt, ap2);
+    va_end(ap2);
+    if (needed < 0) { va_end(ap); return; }
+
+    strbuf_ensure(s, (size_t)needed);
+    vsnprintf(s->buf + s->len, s->cap - s->len, fmt, ap);
+    s->len += (size_t)needed;
+    va_end(ap);
+}
+
+char *strbuf_detach(StrBuf *s) {
+    char *out = s->buf;
+    s->buf = NULL;
+    s->len = 0;
+    s->cap = 0;
+    return out;
+}
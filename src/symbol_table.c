@@ -1,42 +1,61 @@
 #include "symbol_table.h"
+#include "intern.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
 
-/* djb2 string hash (returns size_t). Accepts char* */
+/* Keys are interned before they reach the map, so the hash is a
+ * precomputed header read and equality is pointer identity. */
 static size_t default_str_hash(char* s) {
-    if (!s) return 0;
-    unsigned long hash = 5381;
-    int c;
-    while ((c = (unsigned char)*s++))
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
-    return (size_t)hash;
+    return s ? intern_hash(s) : 0;
 }
 
-/* strcmp-style comparator: 0 if equal */
 static int default_str_cmp(char* a, char* b) {
-    if (a == b) return 0;
-    if (!a) return -1;
-    if (!b) return 1;
-    return strcmp(a, b);
+    return a == b ? 0 : 1;
 }
 
+/* Linear probe of the inline array; fine for its bounded size, and
+ * each compare is one cmp() call (pointer identity by default). */
+static SymbolSmallEntry *small_find(SymbolTable *st, char *key) {
+    for (size_t i = 0; i < st->small_count; ++i) {
+        if (st->cmp(st->small[i].key, key) == 0) return &st->small[i];
+    }
+    return NULL;
+}
 
+/* Move the inline entries into a freshly created hash map. Called once
+ * a table outgrows SYMBOL_TABLE_SMALL_CAP; scopes that stay small
+ * (almost all of them) never allocate buckets at all. */
+static bool small_promote(SymbolTable *st) {
+    st->table = hashmap_create(SYMBOL_TABLE_SMALL_CAP * 4);
+    if (!st->table) return false;
+
+    for (size_t i = 0; i < st->small_count; ++i) {
+        hashmap_put(
+            st->table,
+            st->small[i].key,
+            st->small[i].value,
+            (size_t (*)(void*)) st->hash,
+            (int (*)(void*, void*)) st->cmp
+        );
+    }
+    st->small_count = 0;
+    return true;
+}
 
 SymbolTable* symbol_table_create(size_t bucket_count) {
+    (void)bucket_count; /* buckets are only allocated on promotion */
+
     SymbolTable *st = malloc(sizeof(*st));
     if (!st) return NULL;
 
-    st->table = hashmap_create(bucket_count ? bucket_count : 16);
-    if (!st->table) {
-        free(st);
-        return NULL;
-    }
+    st->table = NULL;
+    st->small_count = 0;
 
     /* sensible defaults (caller can override) */
-    st->free_key = free;       /* strdup'd keys are freed by default */
+    st->free_key = NULL;       /* interned keys are owned by the intern pool */
     st->free_value = NULL;     /* no automatic free for values unless caller sets it */
     st->hash = default_str_hash;
     st->cmp = default_str_cmp;
@@ -51,34 +70,84 @@ void symbol_table_destroy(SymbolTable* table) {
     void (*fk)(void*) = table->free_key ? (void(*)(void*))table->free_key : NULL;
     void (*fv)(void*) = table->free_value ? (void(*)(void*))table->free_value : NULL;
 
-    hashmap_destroy(table->table, fk, fv);
+    if (table->table) {
+        hashmap_destroy(table->table, fk, fv);
+    } else {
+        for (size_t i = 0; i < table->small_count; ++i) {
+            if (fk) fk(table->small[i].key);
+            if (fv) fv(table->small[i].value);
+        }
+    }
     free(table);
 }
 
 bool symbol_table_put(SymbolTable* table, const char* key, Symbol* value) {
     if (!table || !key) return false;
 
-    /* duplicate key so caller keeps ownership of their original string */
-    char *dup = strdup(key);
-    if (!dup) return false;
+    /* canonicalize instead of duplicating: a no-op when the key is
+       already interned (AST names are) */
+    const char *canon = intern_str(key);
+    if (!canon) return false;
 
-    bool ok = hashmap_put(
+    if (!table->table) {
+        SymbolSmallEntry *e = small_find(table, (char*)canon);
+        if (e) {
+            e->value = value; /* update, original key kept */
+            return true;
+        }
+        if (table->small_count < SYMBOL_TABLE_SMALL_CAP) {
+            table->small[table->small_count].key = (char*)canon;
+            table->small[table->small_count].value = value;
+            table->small_count++;
+            return true;
+        }
+        if (!small_promote(table)) return false;
+    }
+
+    return hashmap_put(
         table->table,
-        (void*)dup,
+        (void*)canon,
         (void*)value,
         (size_t (*)(void*)) table->hash,
         (int (*)(void*, void*)) table->cmp
     );
+}
+
+bool symbol_table_put_raw(SymbolTable* table, char* key, Symbol* value) {
+    if (!table || !key) return false;
 
-    if (!ok) {
-        free(dup);
+    if (!table->table) {
+        SymbolSmallEntry *e = small_find(table, key);
+        if (e) {
+            e->value = value; /* update, original key kept */
+            return true;
+        }
+        if (table->small_count < SYMBOL_TABLE_SMALL_CAP) {
+            table->small[table->small_count].key = key;
+            table->small[table->small_count].value = value;
+            table->small_count++;
+            return true;
+        }
+        if (!small_promote(table)) return false;
     }
-    return ok;
+
+    return hashmap_put(
+        table->table,
+        (void*)key,
+        (void*)value,
+        (size_t (*)(void*)) table->hash,
+        (int (*)(void*, void*)) table->cmp
+    );
 }
 
-Symbol* symbol_table_get(SymbolTable* table, const char* key) {
+Symbol* symbol_table_get_raw(SymbolTable* table, const char* key) {
     if (!table || !key) return NULL;
 
+    if (!table->table) {
+        SymbolSmallEntry *e = small_find(table, (char*)key);
+        return e ? e->value : NULL;
+    }
+
     void *v = hashmap_get(
         table->table,
         (void*)key,
@@ -88,12 +157,42 @@ Symbol* symbol_table_get(SymbolTable* table, const char* key) {
     return (Symbol*)v;
 }
 
+Symbol* symbol_table_get(SymbolTable* table, const char* key) {
+    if (!table || !key) return NULL;
+
+    char *canon = (char*)intern_str(key);
+
+    if (!table->table) {
+        SymbolSmallEntry *e = small_find(table, canon);
+        return e ? e->value : NULL;
+    }
+
+    void *v = hashmap_get(
+        table->table,
+        (void*)canon,
+        (size_t (*)(void*)) table->hash,
+        (int (*)(void*, void*)) table->cmp
+    );
+    return (Symbol*)v;
+}
+
 bool symbol_table_remove(SymbolTable* table, const char* key) {
     if (!table || !key) return false;
 
+    char *canon = (char*)intern_str(key);
+
+    if (!table->table) {
+        SymbolSmallEntry *e = small_find(table, canon);
+        if (!e) return false;
+        if (table->free_key) table->free_key(e->key);
+        if (table->free_value) table->free_value(e->value);
+        *e = table->small[--table->small_count]; /* swap in the last entry */
+        return true;
+    }
+
     return hashmap_remove(
         table->table,
-        (void*)key,
+        (void*)canon,
         (size_t (*)(void*)) table->hash,
         (int (*)(void*, void*)) table->cmp,
         table->free_key ? (void(*)(void*))table->free_key : NULL,
@@ -104,6 +203,8 @@ bool symbol_table_remove(SymbolTable* table, const char* key) {
 bool symbol_table_rehash(SymbolTable* table, size_t new_bucket_count) {
     if (!table) return false;
 
+    if (!table->table && !small_promote(table)) return false;
+
     return hashmap_rehash(
         table->table,
         new_bucket_count,
@@ -114,7 +215,7 @@ bool symbol_table_rehash(SymbolTable* table, size_t new_bucket_count) {
 
 size_t symbol_table_size(SymbolTable* table) {
     if (!table) return 0;
-    return hashmap_size(table->table);
+    return table->table ? hashmap_size(table->table) : table->small_count;
 }
 
 void symbol_table_foreach(
@@ -123,14 +224,35 @@ void symbol_table_foreach(
 ) {
     if (!table || !func) return;
 
+    if (!table->table) {
+        for (size_t i = 0; i < table->small_count; ++i)
+            func(table->small[i].key, table->small[i].value);
+        return;
+    }
+
     HashMap *map = table->table;
-    if (!map) return;
+    for (size_t i = 0; i < map->capacity; ++i) {
+        HashSlot *slot = &map->slots[i];
+        if (hashslot_occupied(slot)) func((char*)slot->key, (Symbol*)slot->value);
+    }
+}
 
-    for (size_t i = 0; i < map->bucket_count; ++i) {
-        DynArray *bucket = &map->buckets[i];
-        for (size_t j = 0; j < bucket->count; ++j) {
-            KeyValue *kv = (KeyValue*)dynarray_get(bucket, j);
-            func((char*)kv->key, (Symbol*)kv->value);
-        }
+void symbol_table_foreach_ctx(
+    SymbolTable* table,
+    void (*func)(char* key, Symbol* value, void* ctx),
+    void* ctx
+) {
+    if (!table || !func) return;
+
+    if (!table->table) {
+        for (size_t i = 0; i < table->small_count; ++i)
+            func(table->small[i].key, table->small[i].value, ctx);
+        return;
+    }
+
+    HashMap *map = table->table;
+    for (size_t i = 0; i < map->capacity; ++i) {
+        HashSlot *slot = &map->slots[i];
+        if (hashslot_occupied(slot)) func((char*)slot->key, (Symbol*)slot->value, ctx);
     }
 }
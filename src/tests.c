@@ -5,6 +5,7 @@
  */
 
 #include "driver.h"   /* provides CompilerOptions and run_compiler */
+#include "stats.h"    /* backtracking canary reads the rewind counter */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -478,6 +479,27 @@ static void run_all_tests(void) {
     );
 
 
+    /* 13) Backtracking canary: every statement form dispatches on at
+       most two tokens of lookahead, so a run over the ambiguous-looking
+       declaration/expression mix above must never rewind. A non-zero
+       counter means someone reintroduced a speculative parse — memoize
+       it (key on Parser.current) instead of re-parsing. */
+    RUN(
+      "fn main() { a: i32 = 1; b: i32 = a + 2; a = b; main(); "
+      "arr: i32[3]; arr[a] = 3; a++; --b; c: fn(i32) -> i32; }",
+      "mixed declaration/expression statements parse predictively", false
+    );
+#ifndef COMPILER_NO_STATS /* the rewind counter is compiled out otherwise */
+    g_tests_run++;
+    if (g_stats.parser_rewinds == 0) {
+        g_tests_passed++;
+    } else {
+        printf("❌ Test 'no parser rewinds on predictive input' failed\n");
+        printf("   expected: 0 rewinds\n");
+        printf("   got     : %lu\n", g_stats.parser_rewinds);
+    }
+#endif
+
     double t_end = now_seconds();
 
     int failed = g_tests_run - g_tests_passed;
@@ -1,27 +1,34 @@
 #include "token.h"
+#include "utils.h"
+#include "arena.h"
+#include "intern.h"
 
-Token *create_token(TokenType type, const char *value, size_t len, int line, int column) {
-    Token *tok = malloc(sizeof(Token));
-    if (!tok) {
-        fprintf(stderr, "Memory allocation failed for token\n");
-        exit(EXIT_FAILURE);
-    }
-    tok->type = type;
-    tok->lexeme = strndup(value, len);
-    tok->line = line;
-    tok->col = column;
+Token token_make(TokenType type, const char *value, size_t len) {
+    Token tok;
+    tok.type = type;
+    tok.start = value; /* non-owning: points into the source buffer */
+    tok.len = len;
     return tok;
 }
 
-void free_token(Token *tok) {
-    if (tok) {
-        free((char *)tok->lexeme); // lexeme is allocated with strndup
-        free(tok);
-    }
+/* NUL-terminated copy of the lexeme slice, for consumers that need a
+ * C string outliving the source buffer (AST names, etc.). Allocated
+ * from the compile arena when one is installed. */
+char *token_lexeme_dup(const Token *tok) {
+    if (!tok || !tok->start) return NULL;
+    return arena_strndup_current(tok->start, tok->len);
+}
+
+/* Canonical interned copy of the lexeme. Names that get compared and
+ * hashed over and over (identifiers, parameters, base types) should go
+ * through here so they share one pointer per spelling. */
+const char *token_lexeme_intern(const Token *tok) {
+    if (!tok || !tok->start) return NULL;
+    return intern_strn(tok->start, tok->len);
 }
 
 TokenInfo token_info[NUM_TOKENS] = {
-    #define X(name, str, regex) { name, str, regex, {0} },
+    #define X(name, str, regex) { name, str, regex },
     #include "tokens.def"
     #undef X
 };
@@ -36,12 +43,13 @@ const char *token_type_to_string(TokenType t) {
     return token_names[t] ? token_names[t] : "UNKNOWN";
 }
 
-void print_token(Token *tok) {
-    printf("<%s: \"%s\"> at %d:%d\n",
+void print_token(const Token *tok, LineIndex *li) {
+    size_t line, col;
+    line_index_locate(li, tok->start, &line, &col);
+    printf("<%s: \"%.*s\"> at %zu:%zu\n",
            token_type_to_string(tok->type),
-           tok->lexeme,
-           tok->line,
-           tok->col);
+           (int)tok->len, tok->start ? tok->start : "",
+           line, col);
 }
 
 #define COLOR_RESET   "\x1b[0m"
@@ -50,13 +58,15 @@ void print_token(Token *tok) {
 #define COLOR_POS     "\x1b[0;37m"  // light gray
 #define COLOR_ERROR   "\x1b[1;31m"  // bold red
 
-void print_token_colored(Token *tok) {
-    printf(COLOR_TYPE "<%s>" COLOR_RESET " " 
-           COLOR_VALUE "\"%s\"" COLOR_RESET " " 
-           COLOR_POS "%d:%d" COLOR_RESET "\n",
+void print_token_colored(const Token *tok, LineIndex *li) {
+    size_t line, col;
+    line_index_locate(li, tok->start, &line, &col);
+    printf(COLOR_TYPE "<%s>" COLOR_RESET " "
+           COLOR_VALUE "\"%.*s\"" COLOR_RESET " "
+           COLOR_POS "%zu:%zu" COLOR_RESET "\n",
            token_type_to_string(tok->type),
-           tok->lexeme ? tok->lexeme : "",
-           tok->line, tok->col);
+           (int)tok->len, tok->start ? tok->start : "",
+           line, col);
 }
 
 void token_array_init(TokenArray *arr) {
@@ -64,48 +74,219 @@ void token_array_init(TokenArray *arr) {
     arr->size = arr->capacity = 0;
 }
 
-void token_array_push(TokenArray *arr, Token *tok) {
+void token_array_push(TokenArray *arr, Token tok) {
     if (arr->size + 1 > arr->capacity) {
         arr->capacity = arr->capacity ? arr->capacity*2 : 8;
-        arr->data = realloc(arr->data, sizeof *arr->data * arr->capacity);
-        if (!arr->data) {
-            perror("realloc");
-            exit(1);
-        }
+        arr->data = xrealloc(arr->data, sizeof *arr->data * arr->capacity);
     }
     arr->data[arr->size++] = tok;
 }
 
 void token_array_free(TokenArray *arr) {
-    for (size_t i = 0; i < arr->size; i++) {
-        free_token(arr->data[i]);
-    }
     free(arr->data);
     arr->data = NULL;
     arr->size = arr->capacity = 0;
 }
 
+/* -----------------------
+ * bulk dump writer
+ *
+ * Dumping millions of tokens through one fprintf each costs more than
+ * lexing them, so the dump paths serialize into a large user-space
+ * buffer and hand it to fwrite in batches.
+ * --------------------- */
+
+#define TOKEN_WRITER_CAP (1 << 18)
+
+typedef struct {
+    FILE *out;
+    char *buf;
+    size_t len;
+} TokenWriter;
+
+static void tw_init(TokenWriter *w, FILE *out) {
+    w->out = out;
+    w->buf = xmalloc(TOKEN_WRITER_CAP);
+    w->len = 0;
+}
+
+static void tw_flush(TokenWriter *w) {
+    if (w->len) fwrite(w->buf, 1, w->len, w->out);
+    w->len = 0;
+}
+
+static void tw_finish(TokenWriter *w) {
+    tw_flush(w);
+    free(w->buf);
+    w->buf = NULL;
+}
+
+static void tw_put(TokenWriter *w, const char *data, size_t len) {
+    if (w->len + len > TOKEN_WRITER_CAP) {
+        tw_flush(w);
+        if (len > TOKEN_WRITER_CAP) { /* oversized lexeme: write through */
+            fwrite(data, 1, len, w->out);
+            return;
+        }
+    }
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+}
+
+static void tw_put_str(TokenWriter *w, const char *s) {
+    tw_put(w, s, strlen(s));
+}
+
+static void tw_put_int(TokenWriter *w, long v) {
+    char tmp[24];
+    int len = snprintf(tmp, sizeof tmp, "%ld", v);
+    tw_put(w, tmp, (size_t)len);
+}
+
+/* Lexeme slice with JSON string escaping. */
+static void tw_put_json_escaped(TokenWriter *w, const char *s, size_t len) {
+    size_t run = 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"' || c == '\\' || c < 0x20) {
+            if (run) tw_put(w, s + i - run, run);
+            run = 0;
+            char esc[8];
+            switch (c) {
+                case '"':  tw_put(w, "\\\"", 2); break;
+                case '\\': tw_put(w, "\\\\", 2); break;
+                case '\n': tw_put(w, "\\n", 2); break;
+                case '\t': tw_put(w, "\\t", 2); break;
+                case '\r': tw_put(w, "\\r", 2); break;
+                default:
+                    snprintf(esc, sizeof esc, "\\u%04x", c);
+                    tw_put(w, esc, 6);
+                    break;
+            }
+        } else {
+            run++;
+        }
+    }
+    if (run) tw_put(w, s + len - run, run);
+}
+
 /**
  * Dumps an array of tokens as JSON to the given FILE* stream.
  *
  * @param out      The output stream (e.g. stdout or a file opened for writing).
- * @param tokens   Array of Token* pointers.
+ * @param tokens   Array of Token values.
  * @param n        Number of tokens in the array.
  */
-void dump_tokens_json_fp(FILE *out, Token **tokens, size_t n) {
+void dump_tokens_json_fp(FILE *out, const Token *tokens, size_t n,
+                         const char *source) {
+    if (!out) return;
+
+    LineIndex li;
+    line_index_init(&li, source);
+
+    TokenWriter w;
+    tw_init(&w, out);
+
+    tw_put_str(&w, "[\n");
+    for (size_t i = 0; i < n; i++) {
+        const Token *t = &tokens[i];
+        size_t line, col;
+        line_index_locate(&li, t->start, &line, &col);
+        tw_put_str(&w, "  { \"type\": \"");
+        tw_put_str(&w, token_type_to_string(t->type));
+        tw_put_str(&w, "\", \"value\": \"");
+        if (t->start) tw_put_json_escaped(&w, t->start, t->len);
+        tw_put_str(&w, "\", \"line\": ");
+        tw_put_int(&w, (long)line);
+        tw_put_str(&w, ", \"col\": ");
+        tw_put_int(&w, (long)col);
+        tw_put_str(&w, (i + 1 < n) ? " },\n" : " }\n");
+    }
+    tw_put_str(&w, "]\n");
+
+    tw_finish(&w);
+    line_index_free(&li);
+}
+
+/* Colored dump used by --tokens; same output as print_token_colored
+ * per line, but batched instead of one printf per token. */
+void dump_tokens_colored_fp(FILE *out, const Token *tokens, size_t n,
+                            const char *source) {
     if (!out) return;
-    fprintf(out, "[\n");
+
+    LineIndex li;
+    line_index_init(&li, source);
+
+    TokenWriter w;
+    tw_init(&w, out);
+
     for (size_t i = 0; i < n; i++) {
-        Token *t = tokens[i];
-        fprintf(out,
-                "  { \"type\": \"%s\", \"value\": \"%s\", \"line\": %d, \"col\": %d }%s\n",
-                token_type_to_string(t->type),
-                t->lexeme ? t->lexeme : "",
-                t->line,
-                t->col,
-                (i + 1 < n) ? "," : "");
+        const Token *t = &tokens[i];
+        size_t line, col;
+        line_index_locate(&li, t->start, &line, &col);
+        tw_put_str(&w, COLOR_TYPE "<");
+        tw_put_str(&w, token_type_to_string(t->type));
+        tw_put_str(&w, ">" COLOR_RESET " " COLOR_VALUE "\"");
+        if (t->start) tw_put(&w, t->start, t->len);
+        tw_put_str(&w, "\"" COLOR_RESET " " COLOR_POS);
+        tw_put_int(&w, (long)line);
+        tw_put_str(&w, ":");
+        tw_put_int(&w, (long)col);
+        tw_put_str(&w, COLOR_RESET "\n");
+    }
+
+    tw_finish(&w);
+    line_index_free(&li);
+}
+
+/* Binary token stream: "CTOK" header then one fixed-width record per
+ * token, offsets relative to source_base so consumers can slice the
+ * original file. Written in TOKEN_BIN_BATCH-record fwrite batches. */
+#define TOKEN_BIN_BATCH 8192
+
+void dump_tokens_bin_fp(FILE *out, const Token *tokens, size_t n,
+                        const char *source_base) {
+    if (!out) return;
+
+    TokenBinHeader hdr;
+    memcpy(hdr.magic, TOKEN_BIN_MAGIC, 4);
+    hdr.version = TOKEN_BIN_VERSION;
+    hdr.count = (uint64_t)n;
+    fwrite(&hdr, sizeof hdr, 1, out);
+
+    LineIndex li;
+    line_index_init(&li, source_base);
+
+    TokenBinRecord batch[TOKEN_BIN_BATCH];
+    size_t filled = 0;
+    for (size_t i = 0; i < n; i++) {
+        const Token *t = &tokens[i];
+        size_t line, col;
+        line_index_locate(&li, t->start, &line, &col);
+        TokenBinRecord *r = &batch[filled++];
+        r->type = (uint32_t)t->type;
+        r->len = (uint32_t)t->len;
+        r->offset = t->start ? (uint64_t)(t->start - source_base) : 0;
+        r->line = (uint32_t)line;
+        r->col = (uint32_t)col;
+        if (filled == TOKEN_BIN_BATCH) {
+            fwrite(batch, sizeof(TokenBinRecord), filled, out);
+            filled = 0;
+        }
+    }
+    if (filled) fwrite(batch, sizeof(TokenBinRecord), filled, out);
+    line_index_free(&li);
+}
+
+void dump_tokens_bin_file(const char *filename, const Token *tokens, size_t n,
+                          const char *source_base) {
+    FILE *out = fopen(filename, "wb");
+    if (!out) {
+        perror("fopen");
+        return;
     }
-    fprintf(out, "]\n");
+    dump_tokens_bin_fp(out, tokens, n, source_base);
+    fclose(out);
 }
 
 /**
@@ -113,10 +294,11 @@ void dump_tokens_json_fp(FILE *out, Token **tokens, size_t n) {
  * If filename is NULL or "-", writes to stdout.
  *
  * @param filename The path of the file to write, or "-"/NULL for stdout.
- * @param tokens   Array of Token* pointers.
+ * @param tokens   Array of Token values.
  * @param n        Number of tokens in the array.
  */
-void dump_tokens_json_file(const char *filename, Token **tokens, size_t n) {
+void dump_tokens_json_file(const char *filename, const Token *tokens, size_t n,
+                           const char *source) {
     FILE *out = NULL;
     if (!filename || strcmp(filename, "-") == 0) {
         out = stdout;
@@ -128,7 +310,7 @@ void dump_tokens_json_file(const char *filename, Token **tokens, size_t n) {
         }
     }
 
-    dump_tokens_json_fp(out, tokens, n);
+    dump_tokens_json_fp(out, tokens, n, source);
 
     if (out != stdout) {
         fclose(out);
@@ -11,158 +11,199 @@
 
 #include "type.h"
 #include "utils.h"
+#include "arena.h"
+#include "strbuf.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <stdarg.h>
 
 /* -----------------------
- * simple string builder
+ * Type creation helpers
+ *
+ * Types are hash-consed: constructors return one canonical Type* per
+ * structure, so equality is a pointer compare and 10,000 i32 variables
+ * share a single object. Because children are interned before their
+ * parents, hashing and comparison are shallow -- child Type pointers
+ * and the interned primitive name compare by identity. The table is
+ * per-thread (like the string intern pool) and only engages while a
+ * compile arena is installed; without one, each call still returns a
+ * fresh heap node that type_free can release safely.
  * --------------------- */
-typedef struct {
-    char *buf;
-    size_t len;
-    size_t cap;
-} sbuf;
-
-static void sbuf_init(sbuf *s) {
-    s->cap = 128;
-    s->buf = xmalloc(s->cap);
-    s->len = 0;
-    s->buf[0] = '\0';
-}
 
-static void sbuf_free(sbuf *s) {
-    if (!s) return;
-    free(s->buf);
-    s->buf = NULL;
-    s->len = 0;
-    s->cap = 0;
-}
+#include "hash_map.h"
+#include "intern.h"
 
-static void sbuf_ensure(sbuf *s, size_t extra) {
-    if (s->len + extra + 1 > s->cap) {
-        while (s->len + extra + 1 > s->cap) s->cap *= 2;
-        s->buf = xrealloc(s->buf, s->cap);
+#include <stdint.h>
+
+static _Thread_local HashMap *g_type_table;
+
+static size_t type_shallow_hash(void *key) {
+    const Type *t = key;
+    size_t h = 1469598103934665603UL;
+    h = (h ^ (size_t)t->kind) * 1099511628211UL;
+    h = (h ^ (size_t)t->is_const) * 1099511628211UL;
+    switch (t->kind) {
+        case TYPE_PRIMITIVE:
+            h = (h ^ (size_t)(uintptr_t)t->primitive.name) * 1099511628211UL;
+            break;
+        case TYPE_POINTER:
+            h = (h ^ (size_t)(uintptr_t)t->pointer.to) * 1099511628211UL;
+            break;
+        case TYPE_ARRAY:
+            h = (h ^ (size_t)(uintptr_t)t->array.of) * 1099511628211UL;
+            h = (h ^ t->array.size) * 1099511628211UL;
+            break;
+        case TYPE_FUNCTION:
+            h = (h ^ (size_t)(uintptr_t)t->function.return_type) * 1099511628211UL;
+            for (size_t i = 0; i < t->function.param_count; ++i)
+                h = (h ^ (size_t)(uintptr_t)t->function.params[i]) * 1099511628211UL;
+            break;
     }
+    return h;
 }
 
-static void sbuf_append(sbuf *s, const char *str) {
-    if (!str) return;
-    size_t add = strlen(str);
-    sbuf_ensure(s, add);
-    memcpy(s->buf + s->len, str, add);
-    s->len += add;
-    s->buf[s->len] = '\0';
+static int type_shallow_cmp(void *a, void *b) {
+    const Type *x = a, *y = b;
+    if (x->kind != y->kind || x->is_const != y->is_const) return 1;
+    switch (x->kind) {
+        case TYPE_PRIMITIVE:
+            return x->primitive.name != y->primitive.name;
+        case TYPE_POINTER:
+            return x->pointer.to != y->pointer.to;
+        case TYPE_ARRAY:
+            return x->array.of != y->array.of || x->array.size != y->array.size;
+        case TYPE_FUNCTION:
+            if (x->function.return_type != y->function.return_type ||
+                x->function.param_count != y->function.param_count) return 1;
+            for (size_t i = 0; i < x->function.param_count; ++i)
+                if (x->function.params[i] != y->function.params[i]) return 1;
+            return 0;
+    }
+    return 1;
 }
 
-static void sbuf_appendf(sbuf *s, const char *fmt, ...) {
-    va_list ap;
-    va_start(ap, fmt);
-    /* compute needed size */
-    va_list ap2;
-    va_copy(ap2, ap);
-    int needed = vsnprintf(NULL, 0, fmt, ap2);
-    va_end(ap2);
-    if (needed < 0) { va_end(ap); return; }
-
-    sbuf_ensure(s, (size_t)needed);
-    vsnprintf(s->buf + s->len, s->cap - s->len, fmt, ap);
-    s->len += (size_t)needed;
-    va_end(ap);
+/* Return the canonical node for candidate, creating it in the arena on
+ * first sight. Candidate fields must already be canonical (interned
+ * name, consed children). */
+static Type *type_intern(const Type *candidate) {
+    if (!arena_active()) {
+        /* no arena: plain heap node, uniquely owned by the caller */
+        Type *t = arena_alloc_current(sizeof(*t));
+        *t = *candidate;
+        return t;
+    }
+
+    if (!g_type_table) g_type_table = hashmap_create(64);
+
+    Type *found = hashmap_get(g_type_table, (void *)candidate,
+                              type_shallow_hash, type_shallow_cmp);
+    if (found) return found;
+
+    Type *t = arena_alloc_current(sizeof(*t));
+    *t = *candidate;
+    hashmap_put(g_type_table, t, t, type_shallow_hash, type_shallow_cmp);
+    return t;
 }
 
-/* -----------------------
- * Type creation helpers
- * --------------------- */
+/* Drop the canonical table; the types it points at belong to the
+ * compile arena, so this must run before arena_destroy (next to
+ * intern_reset in the driver). */
+void type_table_reset(void) {
+    if (!g_type_table) return;
+    hashmap_destroy(g_type_table, NULL, NULL);
+    g_type_table = NULL;
+}
 
 Type *type_make_primitive(const char *name, int is_const) {
-    Type *t = xmalloc(sizeof(*t));
-    t->kind = TYPE_PRIMITIVE;
-    t->is_const = !!is_const;
-    t->primitive.name = xstrdup(name ? name : "(anon)");
-    return t;
+    Type c = {0};
+    c.kind = TYPE_PRIMITIVE;
+    c.is_const = !!is_const;
+    if (arena_active())
+        c.primitive.name = (char *)intern_str(name ? name : "(anon)");
+    else
+        c.primitive.name = arena_strdup_current(name ? name : "(anon)");
+    return type_intern(&c);
 }
 
 Type *type_make_pointer(Type *to, int is_const) {
-    Type *t = xmalloc(sizeof(*t));
-    t->kind = TYPE_POINTER;
-    t->is_const = !!is_const;
-    t->pointer.to = to;
-    return t;
+    Type c = {0};
+    c.kind = TYPE_POINTER;
+    c.is_const = !!is_const;
+    c.pointer.to = to;
+    return type_intern(&c);
 }
 
 Type *type_make_array(Type *of, size_t size, int is_const) {
-    Type *t = xmalloc(sizeof(*t));
-    t->kind = TYPE_ARRAY;
-    t->is_const = !!is_const;
-    t->array.of = of;
-    t->array.size = size;
-    return t;
+    Type c = {0};
+    c.kind = TYPE_ARRAY;
+    c.is_const = !!is_const;
+    c.array.of = of;
+    c.array.size = size;
+    return type_intern(&c);
 }
 
 Type *type_make_function(Type *return_type, Type **params, size_t param_count, int is_const) {
-    Type *t = xmalloc(sizeof(*t));
-    t->kind = TYPE_FUNCTION;
-    t->is_const = !!is_const;
-    t->function.return_type = return_type;
-    t->function.params = params;
-    t->function.param_count = param_count;
-    return t;
+    Type c = {0};
+    c.kind = TYPE_FUNCTION;
+    c.is_const = !!is_const;
+    c.function.return_type = return_type;
+    c.function.params = params;
+    c.function.param_count = param_count;
+    return type_intern(&c);
 }
 
 
-static void type_to_string_append(Type *t, sbuf *sb) {
-    if (!t) { sbuf_append(sb, "<null>"); return; }
-    if (t->is_const) sbuf_append(sb, "const ");
+static void type_to_string_append(Type *t, StrBuf *sb) {
+    if (!t) { strbuf_append(sb, "<null>"); return; }
+    if (t->is_const) strbuf_append(sb, "const ");
     switch (t->kind) {
         case TYPE_PRIMITIVE:
-            sbuf_append(sb, t->primitive.name);
+            strbuf_append(sb, t->primitive.name);
             break;
 
         case TYPE_POINTER:
             if (t->pointer.to && t->pointer.to->kind == TYPE_FUNCTION) {
-                sbuf_append(sb, "(");
+                strbuf_append(sb, "(");
                 type_to_string_append(t->pointer.to, sb);
-                sbuf_append(sb, ")*");
+                strbuf_append(sb, ")*");
             } else {
                 type_to_string_append(t->pointer.to, sb);
-                sbuf_append(sb, "*");
+                strbuf_append(sb, "*");
             }
             break;
 
         case TYPE_ARRAY:
             if (t->array.of && t->array.of->kind == TYPE_FUNCTION) {
-                sbuf_append(sb, "(");
+                strbuf_append(sb, "(");
                 type_to_string_append(t->array.of, sb);
-                sbuf_append(sb, ")");
+                strbuf_append(sb, ")");
             } else {
                 type_to_string_append(t->array.of, sb);
             }
-            if (t->array.size == 0) sbuf_append(sb, "[]");
-            else sbuf_appendf(sb, "[%zu]", t->array.size);
+            if (t->array.size == 0) strbuf_append(sb, "[]");
+            else strbuf_appendf(sb, "[%zu]", t->array.size);
             break;
 
         case TYPE_FUNCTION:
-            sbuf_append(sb, "fn(");
+            strbuf_append(sb, "fn(");
             for (size_t i = 0; i < t->function.param_count; ++i) {
                 if (t->function.params[i]) {
                     type_to_string_append(t->function.params[i], sb);
                 } else {
-                    sbuf_append(sb, "<unknown>");
+                    strbuf_append(sb, "<unknown>");
                 }
-                if (i + 1 < t->function.param_count) sbuf_append(sb, ", ");
+                if (i + 1 < t->function.param_count) strbuf_append(sb, ", ");
             }
-            sbuf_append(sb, ")");
+            strbuf_append(sb, ")");
             if (t->function.return_type) {
-                sbuf_append(sb, " -> ");
+                strbuf_append(sb, " -> ");
                 type_to_string_append(t->function.return_type, sb);
             }
             break;
 
         default:
-            sbuf_append(sb, "<unknown-type>");
+            strbuf_append(sb, "<unknown-type>");
             break;
     }
 }
@@ -216,11 +257,42 @@ void type_print(Type *t) {
 
 char *type_to_string(Type *t) {
     if (!t) return xstrdup("(null)");
-    sbuf sb; sbuf_init(&sb);
+    StrBuf sb; strbuf_init(&sb);
     type_to_string_append(t, &sb);
-    char *out = xstrdup(sb.buf);
-    sbuf_free(&sb);
-    return out;
+    return strbuf_detach(&sb);
+}
+
+Type *type_clone_heap(const Type *t) {
+    if (!t) return NULL;
+
+    Type *c = xcalloc(1, sizeof *c);
+    c->kind = t->kind;
+    c->is_const = t->is_const;
+    switch (t->kind) {
+        case TYPE_PRIMITIVE:
+            c->primitive.name = xstrdup(t->primitive.name);
+            break;
+        case TYPE_POINTER:
+            c->pointer.to = type_clone_heap(t->pointer.to);
+            break;
+        case TYPE_ARRAY:
+            c->array.of = type_clone_heap(t->array.of);
+            c->array.size = t->array.size;
+            break;
+        case TYPE_FUNCTION:
+            c->function.return_type = type_clone_heap(t->function.return_type);
+            c->function.param_count = t->function.param_count;
+            if (t->function.param_count) {
+                c->function.params =
+                    xmalloc(t->function.param_count * sizeof(Type *));
+                for (size_t i = 0; i < t->function.param_count; ++i)
+                    c->function.params[i] = type_clone_heap(t->function.params[i]);
+            }
+            break;
+        default:
+            break;
+    }
+    return c;
 }
 
 /* -----------------------
@@ -229,6 +301,8 @@ char *type_to_string(Type *t) {
 
 void type_free(Type *t) {
     if (!t) return;
+    /* arena-backed types are released wholesale by arena_destroy */
+    if (arena_active()) return;
     switch (t->kind) {
         case TYPE_PRIMITIVE:
             free(t->primitive.name);
@@ -1,5 +1,6 @@
 #include "type_from_ast.h"
 #include "utils.h"
+#include "arena.h"
 
 /* -----------------------
  * AST -> Type conversion
@@ -26,7 +27,7 @@ Type *asttype_to_type(AstType *ast_node_type) {
         if (ast_node_type->param_types) {
             n_params = astnode_array_count(ast_node_type->param_types);
             if (n_params > 0) {
-                param_types = xmalloc(n_params * sizeof(Type *));
+                param_types = arena_alloc_current(n_params * sizeof(Type *));
                 for (size_t i = 0; i < n_params; ++i) {
                     AstNode *param_node = astnode_array_get(ast_node_type->param_types, i);
                     if (param_node && param_node->node_type == AST_TYPE) {
@@ -140,7 +141,7 @@ Type *astfunction_to_type(AstFunctionDeclaration *ast_fn) {
         return type_make_function(ret, NULL, 0, 0);
     }
 
-    Type **params = xmalloc(n * sizeof(Type *));
+    Type **params = arena_alloc_current(n * sizeof(Type *));
     for (size_t i = 0; i < n; ++i) {
         AstNode *pnode = astnode_array_get(ast_fn->params, i);
         if (pnode && pnode->node_type == AST_PARAM) {
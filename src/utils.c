@@ -1,9 +1,15 @@
 #include "utils.h"
+#include "stats.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
+/* Every helper funnels through STATS_XALLOC so --mem-stats can
+ * attribute heap traffic to the current compile phase. The macro is a
+ * thread-local add (nothing when built with -DCOMPILER_NO_STATS). */
+
 void *xmalloc(size_t n) {
+    STATS_XALLOC(n);
     void *p = malloc(n);
     if (!p) {
         perror("malloc");
@@ -13,6 +19,7 @@ void *xmalloc(size_t n) {
 }
 
 void *xcalloc(size_t nmemb, size_t size) {
+    STATS_XALLOC(nmemb * size);
     void *p = calloc(nmemb, size);
     if (!p) {
         perror("calloc");
@@ -22,6 +29,7 @@ void *xcalloc(size_t nmemb, size_t size) {
 }
 
 void *xrealloc(void *p, size_t n) {
+    STATS_XALLOC(n);
     void *r = realloc(p, n);
     if (!r) {
         perror("realloc");
@@ -32,6 +40,7 @@ void *xrealloc(void *p, size_t n) {
 
 char *xstrdup(const char *s){
     if (!s) return NULL;
+    STATS_XALLOC(strlen(s) + 1);
     char *d = strdup(s);
     if (!d) {
         perror("strdup");